@@ -11,14 +11,45 @@
 #include <qtooltip.h>
 #include <qvariant.h>
 #include <qwhatsthis.h>
+#include <qvarlengtharray.h>
+#include <qfontdatabase.h>
+#include <qtconcurrentmap.h>
+#include <qelapsedtimer.h>
+#include <qcoreevent.h>
+#include <qloggingcategory.h>
+#include <qdatastream.h>
+#include <qabstractproxymodel.h>
+#include <qfile.h>
+#include <qscrollbar.h>
+#include <qwindow.h>
+#include <algorithm>
 
 // CHeaderModel -   ,   CHeaderView
 
-// .   
+//        
+Q_LOGGING_CATEGORY(lcHeaderView, "cheaderview.performance")
+
+// .    ,   
+//  ()     
+CHeaderModel::CHeaderModel(QObject *parent):
+    QAbstractTableModel(parent), horizontalSpan(new SpanIndex), verticalSpan(new SpanIndex),
+    horizontalRevision(0), verticalRevision(0), statisticsMode(false)
+{
+    connect(this, SIGNAL(columnsInserted(QModelIndex,int,int)), SLOT(spanColumnsInserted(QModelIndex,int,int)));
+    connect(this, SIGNAL(columnsRemoved(QModelIndex,int,int)), SLOT(spanColumnsRemoved(QModelIndex,int,int)));
+    connect(this, SIGNAL(columnsMoved(QModelIndex,int,int,QModelIndex,int)),
+            SLOT(spanColumnsMoved(QModelIndex,int,int,QModelIndex,int)));
+    connect(this, SIGNAL(rowsInserted(QModelIndex,int,int)), SLOT(spanRowsInserted(QModelIndex,int,int)));
+    connect(this, SIGNAL(rowsRemoved(QModelIndex,int,int)), SLOT(spanRowsRemoved(QModelIndex,int,int)));
+    connect(this, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)),
+            SLOT(spanRowsMoved(QModelIndex,int,int,QModelIndex,int)));
+}
+// .    ( 
+//    )
 CHeaderModel::~CHeaderModel()
 {
-   horizontalSpan.clear();
-   verticalSpan.clear();
+   horizontalSpan.reset();
+   verticalSpan.reset();
 }
 //         
 bool CHeaderModel::headerHasIndex(Qt::Orientation orientation,int row, int column, const QModelIndex &parent) const
@@ -35,12 +66,8 @@ QModelIndex CHeaderModel::headerIndex(Qt::Orientation orientation, int row, int
 {
     if  (headerHasIndex(orientation, row, column, parent))
     {
-        QModelIndex index = createIndex(row, column);
-        if (orientation == Qt::Horizontal && horizontalSpan.contains(index))
-            return horizontalSpan.value(index).parent;
-        if (orientation == Qt::Vertical && verticalSpan.contains(index))
-            return verticalSpan.value(index).parent;
-        return index;
+        const Span *span = findSpan(orientation, row, column);
+        return span? createIndex(span->row, span->column) : createIndex(row, column);
     }
    return QModelIndex();
 }
@@ -50,401 +77,3482 @@ void CHeaderModel::headerSpan(Qt::Orientation orientation, int row, int column,
     if (headerHasIndex(orientation, row, column) && rowSpanCount > 0 && columnSpanCount > 0)
     {
         Span item;
-        item.parent          = createIndex(row, column);
+        item.row             = row;
+        item.column          = column;
         item.rowSpanCount    = qBound(1,rowSpanCount,headerCount(orientation)-row);
         item.columnSpanCount = orientation == Qt::Horizontal? qBound(1,columnSpanCount,columnCount()-column) :
                                                               qBound(1,columnSpanCount,rowCount()-column);
 
-        for (int i=row; i<row+item.rowSpanCount; ++i)
-           for (int j=column; j<column+item.columnSpanCount; ++j)
-               if (headerHasIndex(orientation, i, j))
-               {
-                   orientation == Qt::Horizontal? horizontalSpan.insert(createIndex(i,j),item):
-                                                  verticalSpan.insert(createIndex(i,j),item);
-               }
+        QVector<SpanLevel> &levels = editableSpans(orientation);
+        int first = item.first(),
+            last  = item.last();
+        insertSpan(levels, item, first, last);
+
+        emit headerSpanChanged(orientation, first, last);
     }
 }
-//         
-void CHeaderModel::headerClear(Qt::Orientation orientation)
-{
-    if (orientation == Qt::Horizontal)
-        horizontalSpan.clear();
-    else
-    if (orientation == Qt::Vertical)
-        verticalSpan.clear();
-}
-//        
-//     ,  headerDataInternal
-QVariant CHeaderModel::headerData(const QModelIndex &index, Qt::Orientation orientation, int role) const
+//          .
+//     ,    
+//    ,      .
+//  headerSpanChanged         
+void CHeaderModel::headerSetSpans(Qt::Orientation orientation, const QVector<HeaderSpan> &spans)
 {
-  if (index.isValid())
-  {
-    switch (role)
+    int levelCount = headerCount(orientation),
+        sections   = orientation == Qt::Horizontal? columnCount() : rowCount();
+    QVector<SpanLevel> &levels = editableSpans(orientation);
+
+    //  ,     
+    int first = sections,
+        last  = -1;
+    for (int i = 0; i < levels.size(); ++i)
+        if (!levels.at(i).isEmpty())
+        {
+            first = qMin(first, levels.at(i).first().first());
+            last  = qMax(last, levels.at(i).last().last());
+        }
+
+    QVector<SpanLevel> result;
+    //       ,  
+    //    
+    QVector<Span> items;
+    QVector<bool> unordered;
+    for (int i = 0; i < spans.size(); ++i)
     {
-        case CHeaderModel::SectionSpanRole:
+        const HeaderSpan &span = spans.at(i);
+        if (span.row < 0 || span.row >= levelCount || span.column < 0 || span.column >= sections ||
+            span.rowSpanCount <= 0 || span.columnSpanCount <= 0)
+            continue;
+
+        Span item;
+        item.row             = span.row;
+        item.column          = span.column;
+        item.rowSpanCount    = qMin(span.rowSpanCount, levelCount-span.row);
+        item.columnSpanCount = qMin(span.columnSpanCount, sections-span.column);
+        items.append(item);
+
+        if (result.size() < item.row+item.rowSpanCount)
         {
-            if (orientation == Qt::Horizontal)
-                return horizontalSpan.contains(index)? horizontalSpan.value(index).columnSpanCount : 1;
-            if (orientation == Qt::Vertical)
-                return verticalSpan.contains(index)? verticalSpan.value(index).columnSpanCount : 1;
-            return QVariant();
+            result.resize(item.row+item.rowSpanCount);
+            unordered.resize(item.row+item.rowSpanCount);
         }
-        case CHeaderModel::LevelSpanRole:
+        for (int row = item.row; row < item.row+item.rowSpanCount; ++row)
         {
-            if (orientation == Qt::Horizontal)
-                return horizontalSpan.contains(index)? horizontalSpan.value(index).rowSpanCount : 1;
-            if (orientation == Qt::Vertical)
-                return verticalSpan.contains(index)? verticalSpan.value(index).rowSpanCount : 1;
-            return QVariant();
+            SpanLevel &level = result[row];
+            if (!level.isEmpty() && level.last().last() >= item.first())
+                unordered[row] = true;
+            level.append(item);
         }
-        default:
-            return headerDataInternal(index, orientation, role);
+        first = qMin(first, item.first());
+        last  = qMax(last, item.last());
     }
-  }
-  return QVariant();
-}
-
 
+    //    ,   
+    //      
+    bool overlapped = false;
+    for (int row = 0; row < result.size() && !overlapped; ++row)
+    {
+        if (!unordered.at(row))
+            continue;
 
-// CHeaderView  -      
+        SpanLevel &level = result[row];
+        std::stable_sort(level.begin(), level.end(), spanBefore);
+        for (int i = 1; i < level.size() && !overlapped; ++i)
+            overlapped = level.at(i).first() <= level.at(i-1).last();
+    }
+    if (overlapped)
+    {
+        result.clear();
+        for (int i = 0; i < items.size(); ++i)
+            insertSpan(result, items.at(i), first, last);
+    }
 
-//     
-CHeaderView::CHeaderView(Qt::Orientation orientation, QWidget *parent):
-    QHeaderView(orientation,parent), levelCount(0)
-{
-    QHeaderView::setMovable(false);
+    levels.swap(result);
+    if (first <= last)
+        emit headerSpanChanged(orientation, first, last);
 }
-
-void CHeaderView::setModel(QAbstractItemModel *model)
+//   ,     first-last, 
+//  (       ).
+//  headerSpanChanged         
+void CHeaderModel::headerReplaceSpans(Qt::Orientation orientation, int first, int last,
+                                      const QVector<HeaderSpan> &spans)
 {
-    QHeaderView::setModel(model);
-    initializeSections();
-}
+    int levelCount = headerCount(orientation),
+        sections   = orientation == Qt::Horizontal? columnCount() : rowCount();
+    QVector<SpanLevel> &levels = editableSpans(orientation);
 
-//        
-// (     )
-void CHeaderView::setSelectionModel(QItemSelectionModel *selectionModel)
-{
-    if (this->selectionModel()) {
-        disconnect(this->selectionModel(), SIGNAL(selectionChanged(QItemSelection,QItemSelection)),
-                   viewport(), SLOT(update()));
+    int changedFirst = sections,
+        changedLast  = -1;
+    for (int row = 0; row < levels.size(); ++row)
+    {
+        SpanLevel::iterator it = firstSpanFrom(levels[row], first);
+        while (it != levels[row].end() && it->first() <= last)
+        {
+            changedFirst = qMin(changedFirst, it->first());
+            changedLast  = qMax(changedLast, it->last());
+            removeSpan(levels, *it);
+            it = firstSpanFrom(levels[row], first);
+        }
     }
 
-    QHeaderView::setSelectionModel(selectionModel);
+    for (int i = 0; i < spans.size(); ++i)
+    {
+        const HeaderSpan &span = spans.at(i);
+        if (span.row < 0 || span.row >= levelCount || span.column < 0 || span.column >= sections ||
+            span.rowSpanCount <= 0 || span.columnSpanCount <= 0)
+            continue;
 
-    if (selectionModel) {
-        connect(selectionModel, SIGNAL(selectionChanged(QItemSelection,QItemSelection)),
-                viewport(), SLOT(update()));
+        Span item;
+        item.row             = span.row;
+        item.column          = span.column;
+        item.rowSpanCount    = qMin(span.rowSpanCount, levelCount-span.row);
+        item.columnSpanCount = qMin(span.columnSpanCount, sections-span.column);
+        changedFirst = qMin(changedFirst, item.first());
+        changedLast  = qMax(changedLast, item.last());
+        insertSpan(levels, item, changedFirst, changedLast);
     }
-}
 
-void CHeaderView::doItemsLayout()
-{
-    initializeSections();
-    QHeaderView::doItemsLayout();
+    if (changedFirst <= changedLast)
+        emit headerSpanChanged(orientation, changedFirst, changedLast);
 }
-
-void CHeaderView::reset()
+//         
+void CHeaderModel::headerClear(Qt::Orientation orientation)
 {
-    initializeSections();
-    QHeaderView::reset();
+    if (spanLevels(orientation).isEmpty())
+        return;
+    editableSpans(orientation).clear();
+
+    int sections = orientation == Qt::Horizontal? columnCount() : rowCount();
+    if (sections > 0)
+        emit headerSpanChanged(orientation, 0, sections-1);
 }
+//   ,   (    )
+const CHeaderModel::Span *CHeaderModel::findSpan(Qt::Orientation orientation, int row, int column) const
+{
+    if (statisticsMode)
+        ++stats.spanLookups;
 
+    const QVector<SpanLevel> &levels = spanLevels(orientation);
+    if (row < 0 || row >= levels.size())
+        return 0;
 
-//      ( )
-//     QHeaderView::initializeSections()
-void CHeaderView::initializeSections()
+    const SpanLevel &level = levels.at(row);
+    SpanLevel::const_iterator it = std::upper_bound(level.constBegin(), level.constEnd(), column, spanStartsAfter);
+    if (it == level.constBegin())
+        return 0;
+    --it;
+    return it->last() >= column? &*it : 0;
+}
+//        .    
+//  :  ,    ,  
+//  (       ).
+//  first-last     
+void CHeaderModel::insertSpan(QVector<SpanLevel> &levels, const Span &span, int &first, int &last)
 {
-    CHeaderModel *cmodel = dynamic_cast<CHeaderModel *>(model());
-    if (cmodel)
-    {
-        levelCount = cmodel->headerCount(orientation());
+    if (levels.size() < span.row+span.rowSpanCount)
+        levels.resize(span.row+span.rowSpanCount);
 
-        int size,bottom = 0;
-        levelBottom.clear();
-
-        for (int row=0; row<levelCount; ++row)
+    for (int row = span.row; row < span.row+span.rowSpanCount; ++row)
+    {
+        SpanLevel::iterator it = firstSpanFrom(levels[row], span.first());
+        while (it != levels[row].end() && it->first() <= span.last())
         {
-            size = 0;
-            for (int col = 0; col < count(); ++col)
-            {
-                QModelIndex index = cmodel->headerIndex(orientation(),row,col);
-
-                //     
-                QSize hint    = cellSizeFromContents(index);
-                QVariant span = cmodel->headerData(index, orientation(), CHeaderModel::LevelSpanRole);
-                int cellspan  = span.canConvert<uint>()? qBound(1,span.value<int>(),levelCount-index.row()) : 1;
-                size = (orientation() == Qt::Horizontal)? qMax(hint.height()/cellspan,size) : qMax(hint.width()/cellspan,size);
-            }
-            bottom+=size;
-            levelBottom.push_back(bottom);
-
+            first = qMin(first, it->first());
+            last  = qMax(last, it->last());
+            removeSpan(levels, *it);
+            it = firstSpanFrom(levels[row], span.first());
         }
     }
 
-    QHeaderView::initializeSections();
+    for (int row = span.row; row < span.row+span.rowSpanCount; ++row)
+    {
+        SpanLevel &level = levels[row];
+        level.insert(std::upper_bound(level.begin(), level.end(), span.first(), spanStartsAfter), span);
+    }
 }
-//      
-//   -     
-QSize CHeaderView::cellSizeFromContents(const QModelIndex &index) const
+//        
+void CHeaderModel::removeSpan(QVector<SpanLevel> &levels, Span span)
 {
+    for (int row = span.row; row < span.row+span.rowSpanCount && row < levels.size(); ++row)
+    {
+        SpanLevel &level = levels[row];
+        SpanLevel::iterator it = firstSpanFrom(level, span.first());
+        if (it != level.end() && it->row == span.row && it->column == span.column)
+            level.erase(it);
+    }
+}
 
+bool CHeaderModel::spanStartsAfter(int column, const Span &span)
+{
+    return column < span.first();
+}
 
+bool CHeaderModel::spanBefore(const Span &span, const Span &other)
+{
+    return span.first() < other.first();
+}
+//    .   
+//  ,  - 
+void CHeaderModel::spanColumnsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (!parent.isValid())
+        headerInsertSections(Qt::Horizontal, first, last-first+1);
+}
 
-    CHeaderModel *cmodel = dynamic_cast<CHeaderModel *>(model());
-
-    if (!index.isValid() || !cmodel)
-        return QSize();
-
-    ensurePolished();
-
-    // use SizeHintRole
-    QVariant variant = cmodel->headerData(index, orientation(), Qt::SizeHintRole);
-    if (variant.isValid())
-        return qvariant_cast<QSize>(variant);
+void CHeaderModel::spanColumnsRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (!parent.isValid())
+        headerRemoveSections(Qt::Horizontal, first, last);
+}
 
-    // otherwise use the contents
-    QStyleOptionHeader opt;
-    initStyleOption(&opt);
-    opt.section = index.column();
-    QVariant var = cmodel->headerData(index, orientation(),
-                                            Qt::FontRole);
-    QFont fnt;
-    if (var.isValid() && var.canConvert<QFont>())
-        fnt = qvariant_cast<QFont>(var);
-    else
-        fnt = font();
-    fnt.setBold(true);
-    opt.fontMetrics = QFontMetrics(fnt);
-    opt.text = cmodel->headerData(index, orientation(),
-                                    Qt::DisplayRole).toString();
-    variant = cmodel->headerData(index, orientation(), Qt::DecorationRole);
-    opt.icon = qvariant_cast<QIcon>(variant);
-    if (opt.icon.isNull())
-        opt.icon = qvariant_cast<QPixmap>(variant);
+void CHeaderModel::spanColumnsMoved(const QModelIndex &parent, int start, int end, const QModelIndex &destination, int column)
+{
+    if (!parent.isValid() && !destination.isValid())
+        headerMoveSections(Qt::Horizontal, start, end, column);
+}
 
-    QSize size = style()->sizeFromContents(QStyle::CT_HeaderSection, &opt, QSize(), this);
-    int SortIndicatorSize = 0;
-    if (isSortIndicatorShown()) {
-        int margin = style()->pixelMetric(QStyle::PM_HeaderMargin, &opt, this);
-        if (orientation() == Qt::Horizontal)
-            SortIndicatorSize = size.height() + margin;
-        else
-            SortIndicatorSize = size.width() + margin;
-    }
-    //    
-    if (cmodel->headerData(index, orientation(), CHeaderModel::RotationRole).toBool())
-        size.transpose();
+void CHeaderModel::spanRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (!parent.isValid())
+        headerInsertSections(Qt::Vertical, first, last-first+1);
+}
 
-    if (orientation() == Qt::Horizontal)
-        size.rwidth() += SortIndicatorSize;
-    else
-        size.rheight() += SortIndicatorSize;
+void CHeaderModel::spanRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (!parent.isValid())
+        headerRemoveSections(Qt::Vertical, first, last);
+}
 
-     return size;
+void CHeaderModel::spanRowsMoved(const QModelIndex &parent, int start, int end, const QModelIndex &destination, int row)
+{
+    if (!parent.isValid() && !destination.isValid())
+        headerMoveSections(Qt::Vertical, start, end, row);
+}
+//     ,     
+//  ,     ()  .
+//       
+void CHeaderModel::headerInsertSections(Qt::Orientation orientation, int first, int count)
+{
+    QVector<SpanLevel> *levels = shiftedSpans(orientation);
+    if (levels)
+        insertSections(*levels, first, count);
 }
 
-//       
-//   -   ()  
-QSize CHeaderView::sectionSizeFromContents(int section) const
+void CHeaderModel::headerRemoveSections(Qt::Orientation orientation, int first, int last)
 {
-    CHeaderModel *cmodel = dynamic_cast<CHeaderModel *>(model());
-    if (!cmodel)
-        return QHeaderView::sectionSizeFromContents(section);
+    QVector<SpanLevel> *levels = shiftedSpans(orientation);
+    if (levels)
+        removeSections(*levels, first, last);
+}
 
-    QSize sectionSizeHint = QSize(0,0);
+void CHeaderModel::headerMoveSections(Qt::Orientation orientation, int start, int end, int destination)
+{
+    QVector<SpanLevel> *levels = shiftedSpans(orientation);
+    if (levels)
+        moveSections(*levels, start, end, destination);
+}
+//      
+const QVector<CHeaderModel::SpanLevel> &CHeaderModel::spanLevels(Qt::Orientation orientation) const
+{
+    return orientation == Qt::Horizontal? horizontalSpan->levels : verticalSpan->levels;
+}
+//      .  
+//     :    
+QVector<CHeaderModel::SpanLevel> &CHeaderModel::editableSpans(Qt::Orientation orientation)
+{
+    if (headerSpanSource(orientation))
+        headerLinkSpans(orientation, 0);
+    return orientation == Qt::Horizontal? horizontalSpan->levels : verticalSpan->levels;
+}
+//          .
+//        , 
+// ,        ,  
+//   (    ),   0
+QVector<CHeaderModel::SpanLevel> *CHeaderModel::shiftedSpans(Qt::Orientation orientation)
+{
+    SpanIndex *index = orientation == Qt::Horizontal? horizontalSpan.data() : verticalSpan.data();
+    int &revision    = orientation == Qt::Horizontal? horizontalRevision : verticalRevision;
+    if (++revision <= index->revision)
+        return 0;
+    index->revision = revision;
+    return &index->levels;
+}
+//     ,     
+CHeaderModel::SpanLevel::iterator CHeaderModel::firstSpanFrom(SpanLevel &level, int column)
+{
+    SpanLevel::iterator it = std::upper_bound(level.begin(), level.end(), column, spanStartsAfter);
+    if (it != level.begin() && (it-1)->last() >= column)
+        --it;
+    return it;
+}
+//  :     , ,
+//    ,  (  QTableView).
+//   ,    
+void CHeaderModel::insertSections(QVector<SpanLevel> &levels, int first, int count)
+{
+    for (int row = 0; row < levels.size(); ++row)
+    {
+        SpanLevel &level = levels[row];
+        for (SpanLevel::iterator it = firstSpanFrom(level, first); it != level.end(); ++it)
+        {
+            if (it->column >= first)
+                it->column += count;
+            else
+                it->columnSpanCount += count;
+        }
+    }
+}
+//         .
+//  false,         
+bool CHeaderModel::removeFromSpan(Span &span, int first, int last)
+{
+    int count = last-first+1,
+        spanLast = span.column+span.columnSpanCount-1;
 
-    if (isSectionHidden(section))
-      return sectionSizeHint;
+    spanLast   = spanLast   < first? spanLast   : (spanLast   > last? spanLast-count   : first-1);
+    span.column = span.column < first? span.column : (span.column > last? span.column-count : first);
+    span.columnSpanCount = spanLast-span.column+1;
 
-    for (int row = 0; row < levelCount; ++row)
+    return span.columnSpanCount > 0 && (span.columnSpanCount > 1 || span.rowSpanCount > 1);
+}
+//  :     , ,
+//   , ,    
+void CHeaderModel::removeSections(QVector<SpanLevel> &levels, int first, int last)
+{
+    for (int row = 0; row < levels.size(); ++row)
     {
-
-        QModelIndex index = cmodel->headerIndex(orientation(),row,section);
-        QSize cellSize = cellSizeFromContents(index);
-        QVariant span = cmodel->headerData(index, orientation(), CHeaderModel::SectionSpanRole);
-        if (span.canConvert<uint>())
+        SpanLevel &level = levels[row];
+        SpanLevel::iterator from = firstSpanFrom(level, first),
+                            to   = from;
+        for (SpanLevel::iterator it = from; it != level.end(); ++it)
         {
-           if (orientation()==Qt::Horizontal)
-               cellSize.rwidth() /= qBound(1,span.value<int>(),count()-index.column());
-           else
-               cellSize.rheight()/= qBound(1,span.value<int>(),count()-index.column());
+            Span span = *it;
+            if (removeFromSpan(span, first, last))
+                *to++ = span;
         }
+        level.erase(to, level.end());
+    }
+}
+//  : ,     , 
+//   ,         
+//    
+void CHeaderModel::moveSections(QVector<SpanLevel> &levels, int start, int end, int destination)
+{
+    int count    = end-start+1,
+        newStart = destination > end? destination-count : destination;
+    if (newStart == start)
+        return;
 
-        span = cmodel->headerData(index, orientation(), CHeaderModel::LevelSpanRole);
-        if (span.canConvert<uint>())
+    //     (    )
+    QVector<Span> carried;
+    for (int row = 0; row < levels.size(); ++row)
+    {
+        SpanLevel &level = levels[row];
+        SpanLevel::iterator to = firstSpanFrom(level, start);
+        for (SpanLevel::iterator it = to; it != level.end(); ++it)
         {
-            if (orientation()==Qt::Horizontal)
-                cellSize.rheight()/= qBound(1,span.value<int>(),levelCount-index.row());
+            if (it->column >= start && it->column+it->columnSpanCount-1 <= end)
+            {
+                if (it->row != row)
+                    continue;
+                Span span = *it;
+                span.column += newStart-start;
+                carried.append(span);
+            }
             else
-                cellSize.rwidth() /= qBound(1,span.value<int>(),levelCount-index.row());
+                *to++ = *it;
         }
+        level.erase(to, level.end());
+    }
 
-        if (orientation()==Qt::Horizontal)
+    removeSections(levels, start, end);
+    insertSections(levels, newStart, count);
+
+    // ,   ,    (  ),
+    //  ,   ,  
+    for (int i = 0; i < carried.size(); ++i)
+    {
+        const Span &span = carried.at(i);
+        bool enclosed = false;
+        for (int row = span.row; row < span.row+span.rowSpanCount && !enclosed; ++row)
         {
-           //         
-            sectionSizeHint.rheight() += cellSize.height();
-            sectionSizeHint.setWidth(qMax(sectionSizeHint.width(), cellSize.width()));
-         }
-         else
-         {
-            //    
-            sectionSizeHint.rwidth() += cellSize.width();
-            sectionSizeHint.setHeight(qMax(sectionSizeHint.height(), cellSize.height()));
-          }
+            SpanLevel::iterator it = firstSpanFrom(levels[row], span.first());
+            enclosed = it != levels[row].end() && it->first() <= span.last();
+        }
+        int first = span.first(),
+            last  = span.last();
+        if (!enclosed)
+            insertSpan(levels, span, first, last);
     }
-    return sectionSizeHint;
-}
-//        
-QModelIndex CHeaderView::IndexAt(const QPoint &pos) const
-{
-   return IndexAt(pos.x(), pos.y());
 }
-//        
-QModelIndex CHeaderView::IndexAt(int ax, int ay) const
+//        
+//     ,  headerDataInternal
+QVariant CHeaderModel::headerData(const QModelIndex &index, Qt::Orientation orientation, int role) const
 {
-    int pos = orientation()==Qt::Horizontal? ay : ax,
-        col = orientation()==Qt::Horizontal? logicalIndexAt(ax): logicalIndexAt(ay);
-
-    if(col >=0)
+  if (statisticsMode)
+      ++stats.dataRequests[role];
+  if (index.isValid())
+  {
+    switch (role)
     {
-        for (int row = 0; row < levelCount; ++row)
+        case CHeaderModel::SectionSpanRole:
         {
-            if (pos < levelBottom.at(row))
-            {
-                CHeaderModel *cmodel = dynamic_cast<CHeaderModel *>(model());
-
-                return !cmodel ? QModelIndex() : cmodel->headerIndex(orientation(),row, col);
-            }
+            if (orientation != Qt::Horizontal && orientation != Qt::Vertical)
+                return QVariant();
+            const Span *span = findSpan(orientation, index.row(), index.column());
+            return span? span->columnSpanCount : 1;
+        }
+        case CHeaderModel::LevelSpanRole:
+        {
+            if (orientation != Qt::Horizontal && orientation != Qt::Vertical)
+                return QVariant();
+            const Span *span = findSpan(orientation, index.row(), index.column());
+            return span? span->rowSpanCount : 1;
         }
+        default:
+            if (statisticsMode)
+                ++stats.internalCalls;
+            return headerDataInternal(index, orientation, role);
     }
-  return QModelIndex();
+  }
+  return QVariant();
 }
-//       
-// (      )
-void CHeaderView::paintSection(QPainter *painter, const QRect &rect, int col) const
+
+//           .
+//        ,
+//     headerMultiDataInternal
+void CHeaderModel::headerMultiData(const QModelIndex &index, Qt::Orientation orientation,
+                                   HeaderRoleData *roleData, int count) const
 {
-    CHeaderModel *cmodel = dynamic_cast<CHeaderModel *>(model());
+    int spanRoles = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        roleData[i].data = QVariant();
+        if (roleData[i].role == SectionSpanRole || roleData[i].role == LevelSpanRole)
+            ++spanRoles;
+    }
 
-    if (!cmodel)
-        return QHeaderView::paintSection(painter,rect,col);
+    if (statisticsMode)
+    {
+        ++stats.multiDataCalls;
+        for (int i = 0; i < count; ++i)
+            ++stats.dataRequests[roleData[i].role];
+        if (index.isValid() && spanRoles < count)
+            ++stats.multiInternalCalls;
+    }
 
-        for (int row = 0; row < levelCount; ++row)
-        {
-            QModelIndex index = cmodel->headerIndex(orientation(),row,col);
+    if (!index.isValid())
+        return;
 
-            if (!index.isValid()) continue;
-            painter->save();
+    if (spanRoles == 0)
+    {
+        headerMultiDataInternal(index, orientation, roleData, count);
+        return;
+    }
 
-            // get the state of the section
-            QStyleOptionHeader opt;
-            initStyleOption(&opt);
+    if (spanRoles < count)
+    {
+        QVarLengthArray<HeaderRoleData,16> internal;
+        for (int i = 0; i < count; ++i)
+            if (roleData[i].role != SectionSpanRole && roleData[i].role != LevelSpanRole)
+                internal.append(roleData[i]);
 
-            QVariant font = cmodel->headerData(index, orientation(), Qt::FontRole);
-            if (font.isValid() && font.canConvert<QFont>()) {
-                QFont sectionFont = qvariant_cast<QFont>(font);
-                painter->setFont(sectionFont);
-            }
+        headerMultiDataInternal(index, orientation, internal.data(), internal.size());
 
-            // setup the style options structure
-            QVariant textAlignment = cmodel->headerData(index, orientation(),
-                                                          Qt::TextAlignmentRole);
-
-            int lastSection = index.column(),
-                lastLevel   = index.row();
-
-            QVariant span = cmodel->headerData(index, orientation(), CHeaderModel::SectionSpanRole);
-            if (span.canConvert<uint>())
-                lastSection = index.column()+qBound(1,span.value<int>(),count()-index.column())-1;
-
-            span = cmodel->headerData(index, orientation(), CHeaderModel::LevelSpanRole);
-            if (span.canConvert<uint>())
-                 lastLevel  = index.row()+qBound(1,span.value<int>(),levelCount-index.row())-1;
-
-            int left   = sectionViewportPosition(index.column()),
-                top    = index.row()==0? 0: levelBottom.at(index.row()-1),
-                width  = sectionViewportPosition(lastSection)+sectionSize(lastSection)-left,
-                height = levelBottom.at(lastLevel)-top;
-
-            opt.rect = orientation() == Qt::Horizontal? QRect(left, top, width, height):
-                                                        QRect(top, left, height, width);
-            opt.section = col;
-
-            opt.textAlignment = Qt::Alignment(textAlignment.isValid()
-                                              ? Qt::Alignment(textAlignment.toInt())
-                                              : Qt::AlignCenter);
-
-            opt.iconAlignment = Qt::AlignVCenter;
-            opt.text = cmodel->headerData(index, orientation(),
-                                            Qt::DisplayRole).toString();
-
-            QVariant variant = cmodel->headerData(index, orientation(),
-                                            Qt::DecorationRole);
-            opt.icon = qvariant_cast<QIcon>(variant);
-            if (opt.icon.isNull())
-                opt.icon = qvariant_cast<QPixmap>(variant);
-            QVariant foregroundBrush = cmodel->headerData(index, orientation(),
-                                                            Qt::ForegroundRole);
-            if (foregroundBrush.canConvert<QBrush>())
-                opt.palette.setBrush(QPalette::ButtonText, qvariant_cast<QBrush>(foregroundBrush));
-
-            QPointF oldBO = painter->brushOrigin();
-            QVariant backgroundBrush = cmodel->headerData(index, orientation(),
-                                                            Qt::BackgroundRole);
-            if (backgroundBrush.canConvert<QBrush>()) {
-                opt.palette.setBrush(QPalette::Button, qvariant_cast<QBrush>(backgroundBrush));
-                opt.palette.setBrush(QPalette::Window, qvariant_cast<QBrush>(backgroundBrush));
-                painter->setBrushOrigin(opt.rect.topLeft());
-            }
+        for (int i = 0, j = 0; i < count; ++i)
+            if (roleData[i].role != SectionSpanRole && roleData[i].role != LevelSpanRole)
+                roleData[i].data = internal[j++].data;
+    }
 
-            // the section position
-            opt.position = QStyleOptionHeader::Middle;
-            opt.orientation = orientation();
+    if (orientation != Qt::Horizontal && orientation != Qt::Vertical)
+        return;
 
+    const Span *span = findSpan(orientation, index.row(), index.column());
+    for (int i = 0; i < count; ++i)
+    {
+        if (roleData[i].role == SectionSpanRole)
+            roleData[i].data = span? span->columnSpanCount : 1;
+        else
+        if (roleData[i].role == LevelSpanRole)
+            roleData[i].data = span? span->rowSpanCount : 1;
+    }
+}
+//      
+void CHeaderModel::headerMultiDataInternal(const QModelIndex &index, Qt::Orientation orientation,
+                                           HeaderRoleData *roleData, int count) const
+{
+    if (statisticsMode)
+        stats.internalCalls += count;
+    for (int i = 0; i < count; ++i)
+        roleData[i].data = headerDataInternal(index, orientation, roleData[i].role);
+}
+//      -:  
+//     ( ),   
+//   ,     headerSpanChanged. 
+//         .
+//      . 0 -  ,
+//    
+void CHeaderModel::headerLinkSpans(Qt::Orientation orientation, CHeaderModel *source)
+{
+    //     
+    for (CHeaderModel *model = source; model; model = model->headerSpanSource(orientation))
+        if (model == this)
+        {
+            source = 0;
+            break;
+        }
 
-            if (isEnabled())
-                opt.state |= QStyle::State_Enabled;
-            if (window()->isActiveWindow())
-                opt.state |= QStyle::State_Active;
+    QPointer<CHeaderModel> &link = orientation == Qt::Horizontal? horizontalLink : verticalLink;
+    CHeaderModel *other = headerSpanSource(orientation == Qt::Horizontal? Qt::Vertical : Qt::Horizontal);
+    if (link == source)
+        return;
+    //       
+    if (link && link != other)
+        connectLink(link, false);
+    link = source;
 
-            opt.selectedPosition = QStyleOptionHeader::NotAdjacent;
+    QExplicitlySharedDataPointer<SpanIndex> &index = orientation == Qt::Horizontal? horizontalSpan : verticalSpan;
+    int &revision = orientation == Qt::Horizontal? horizontalRevision : verticalRevision;
+    if (!link)
+    {
+        index.detach();
+        return;
+    }
 
-            // the selected position
-            if(selectionModel())
-            {
-               if ((orientation() == Qt::Horizontal && selectionModel()->isColumnSelected(index.column(), rootIndex())
-                                                    && selectionModel()->isColumnSelected(lastSection, rootIndex())) ||
-                   (orientation() == Qt::Vertical   && selectionModel()->isRowSelected(index.column(), rootIndex())
-                                                    && selectionModel()->isRowSelected(lastSection, rootIndex())))
-                  opt.state |= QStyle::State_Sunken | QStyle::State_On;
-            }
+    connectLink(link, true);
+    index    = orientation == Qt::Horizontal? link->horizontalSpan : link->verticalSpan;
+    revision = index->revision;
+    int sections = orientation == Qt::Horizontal? columnCount() : rowCount();
+    if (sections > 0)
+        emit headerSpanChanged(orientation, 0, sections-1);
+}
 
-            style()->drawControl(QStyle::CE_HeaderSection, &opt, painter, this);
+//       (  )
+void CHeaderModel::connectLink(CHeaderModel *link, bool connected)
+{
+    if (connected)
+        connect(link, SIGNAL(headerSpanChanged(Qt::Orientation,int,int)),
+                this, SLOT(linkedSpansChanged(Qt::Orientation,int,int)), Qt::UniqueConnection);
+    else
+        disconnect(link, SIGNAL(headerSpanChanged(Qt::Orientation,int,int)),
+                   this, SLOT(linkedSpansChanged(Qt::Orientation,int,int)));
+}
 
-            if (cmodel->headerData(index, orientation(), CHeaderModel::RotationRole).toBool())
-            {
-                painter->translate(opt.rect.left(), opt.rect.top() + opt.rect.height());
-                painter->rotate(-90);
-                opt.rect.setRect(0, 0, opt.rect.height(), opt.rect.width());
-            }
+CHeaderModel *CHeaderModel::headerSpanSource(Qt::Orientation orientation) const
+{
+    return orientation == Qt::Horizontal? horizontalLink.data() : verticalLink.data();
+}
+//    . ,    
+//     ,      ,  .
+// ,        , 
+// ,        
+void CHeaderModel::linkedSpansChanged(Qt::Orientation orientation, int first, int last)
+{
+    CHeaderModel *source = headerSpanSource(orientation);
+    if (!source || sender() != source)
+        return;
+
+    QExplicitlySharedDataPointer<SpanIndex> &index = orientation == Qt::Horizontal? horizontalSpan : verticalSpan;
+    const QExplicitlySharedDataPointer<SpanIndex> &shared = orientation == Qt::Horizontal? source->horizontalSpan :
+                                                                                          source->verticalSpan;
+    if (index != shared)
+    {
+        int &revision = orientation == Qt::Horizontal? horizontalRevision : verticalRevision;
+        index    = shared;
+        revision = index->revision;
+    }
+    if (first <= last)
+        emit headerSpanChanged(orientation, first, last);
+}
+//    :     
+// (    )     
+QByteArray CHeaderModel::headerSaveSpans(Qt::Orientation orientation) const
+{
+    const QVector<SpanLevel> &levels = spanLevels(orientation);
+
+    qint32 count = 0;
+    for (int row = 0; row < levels.size(); ++row)
+        for (int i = 0; i < levels.at(row).size(); ++i)
+            if (levels.at(row).at(i).row == row)
+                ++count;
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_6);
+    stream << count;
+    for (int row = 0; row < levels.size(); ++row)
+    {
+        const SpanLevel &level = levels.at(row);
+        for (int i = 0; i < level.size(); ++i)
+        {
+            const Span &span = level.at(i);
+            if (span.row == row)
+                stream << qint32(span.row) << qint32(span.column)
+                       << qint32(span.rowSpanCount) << qint32(span.columnSpanCount);
+        }
+    }
+    return data;
+}
+//    ,  headerSaveSpans.
+//       ; ,  
+//      ,  
+bool CHeaderModel::headerRestoreSpans(Qt::Orientation orientation, const QByteArray &data)
+{
+    int levelCount = headerCount(orientation),
+        sections   = orientation == Qt::Horizontal? columnCount() : rowCount();
+
+    QVector<SpanLevel> result;
+    int first = sections,
+        last  = -1;
+    if (!decodeSpans(data, levelCount, sections, result, first, last))
+        return false;
+
+    QVector<SpanLevel> &levels = editableSpans(orientation);
+    for (int i = 0; i < levels.size(); ++i)
+        if (!levels.at(i).isEmpty())
+        {
+            first = qMin(first, levels.at(i).first().first());
+            last  = qMax(last, levels.at(i).last().last());
+        }
+
+    levels.swap(result);
+    if (first <= last)
+        emit headerSpanChanged(orientation, first, last);
+    return true;
+}
+//     headerSaveSpans (  -  )
+//   headerSpanChanged.    beginResetModel  endResetModel
+//     :     
+bool CHeaderModel::headerResetSpans(Qt::Orientation orientation, const QByteArray &data)
+{
+    int sections = orientation == Qt::Horizontal? columnCount() : rowCount();
+
+    QVector<SpanLevel> result;
+    int first = sections,
+        last  = -1;
+    if (!data.isEmpty() && !decodeSpans(data, headerCount(orientation), sections, result, first, last))
+        return false;
+
+    editableSpans(orientation).swap(result);
+    return true;
+}
+//   ,  headerSaveSpans,    
+bool CHeaderModel::headerCheckSpans(Qt::Orientation orientation, const QByteArray &data) const
+{
+    return checkSpans(data, headerCount(orientation),
+                      orientation == Qt::Horizontal? columnCount() : rowCount());
+}
+//   ,  headerSaveSpans,  
+//   ,    
+bool CHeaderModel::checkSpans(const QByteArray &data, int levelCount, int sections)
+{
+    QVector<SpanLevel> result;
+    int first = sections,
+        last  = -1;
+    return decodeSpans(data, levelCount, sections, result, first, last);
+}
+//   ,  headerSaveSpans,   result,
+//  first  last    .  
+//     ,      ,
+//        
+bool CHeaderModel::decodeSpans(const QByteArray &data, int levelCount, int sections,
+                               QVector<SpanLevel> &result, int &first, int &last)
+{
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_5_6);
+    qint32 count;
+    stream >> count;
+    if (stream.status() != QDataStream::Ok || count < 0 || qint64(count) > qint64(levelCount)*sections)
+        return false;
+
+    QVector<SpanLevel> levels;
+    for (int i = 0; i < count; ++i)
+    {
+        qint32 values[4];
+        for (int j = 0; j < 4; ++j)
+            stream >> values[j];
+
+        //   ,    
+        Span span;
+        span.row             = values[0];
+        span.column          = values[1];
+        span.rowSpanCount    = values[2];
+        span.columnSpanCount = values[3];
+        if (stream.status() != QDataStream::Ok ||
+            span.row < 0 || span.row >= levelCount || span.column < 0 || span.column >= sections ||
+            span.rowSpanCount < 1 || span.rowSpanCount > levelCount-span.row ||
+            span.columnSpanCount < 1 || span.columnSpanCount > sections-span.column)
+            return false;
+
+        if (levels.size() < span.row+span.rowSpanCount)
+            levels.resize(span.row+span.rowSpanCount);
+        for (int row = span.row; row < span.row+span.rowSpanCount; ++row)
+            levels[row].append(span);
+    }
+    if (!stream.atEnd())
+        return false;
+
+    for (int row = 0; row < levels.size(); ++row)
+    {
+        SpanLevel &level = levels[row];
+        std::sort(level.begin(), level.end(), spanBefore);
+        for (int i = 1; i < level.size(); ++i)
+            if (level.at(i).first() <= level.at(i-1).last())
+                return false;
+        if (!level.isEmpty())
+        {
+            first = qMin(first, level.first().first());
+            last  = qMax(last, level.last().last());
+        }
+    }
+    result.swap(levels);
+    return true;
+}
+//      
+quint32 CHeaderModel::headerContentVersion(Qt::Orientation orientation) const
+{
+    Q_UNUSED(orientation);
+    return 0;
+}
+//     :  ,  ,
+//       .     0
+uint CHeaderModel::headerContentHash(Qt::Orientation orientation) const
+{
+    quint32 version = headerContentVersion(orientation);
+    if (!version)
+        return 0;
+    return qHash(version, headerShapeHash(orientation)) | 1;
+}
+//   :       .
+//     ,    
+uint CHeaderModel::headerShapeHash(Qt::Orientation orientation) const
+{
+    const QVector<SpanLevel> &levels = spanLevels(orientation);
+    int sections = orientation == Qt::Horizontal? columnCount() : rowCount();
+    uint hash = qHash(headerCount(orientation), qHash(sections));
+
+    for (int row = 0; row < levels.size(); ++row)
+    {
+        const SpanLevel &level = levels.at(row);
+        hash = qHash(level.size(), hash);
+        for (int i = 0; i < level.size(); ++i)
+        {
+            const Span &span = level.at(i);
+            hash = qHash(span.row, qHash(span.column, hash));
+            hash = qHash(span.rowSpanCount, qHash(span.columnSpanCount, hash));
+        }
+    }
+    return hash;
+}
+//      .     
+void CHeaderModel::headerSetStatisticsEnabled(bool enabled)
+{
+    statisticsMode = enabled;
+}
+
+bool CHeaderModel::headerStatisticsEnabled() const
+{
+    return statisticsMode;
+}
+
+CHeaderModel::HeaderStatistics CHeaderModel::headerStatistics() const
+{
+    return stats;
+}
+
+void CHeaderModel::headerResetStatistics()
+{
+    stats = HeaderStatistics();
+}
+
+
+// CHeaderProxyAdapter -    CHeaderView,  -  CHeaderModel
+
+// .    -  ,
+//          
+CHeaderProxyAdapter::CHeaderProxyAdapter(Qt::Orientation orientation, QAbstractItemModel *proxy,
+                                         CHeaderModel *source, QObject *parent):
+    CHeaderModel(parent), headerOrientation(orientation), proxy(proxy), source(source), mappedByItems(false)
+{
+    if (orientation == Qt::Horizontal)
+    {
+        connect(proxy, SIGNAL(columnsInserted(QModelIndex,int,int)), SLOT(proxySectionsInserted(QModelIndex,int,int)));
+        connect(proxy, SIGNAL(columnsRemoved(QModelIndex,int,int)), SLOT(proxySectionsRemoved(QModelIndex,int,int)));
+        connect(proxy, SIGNAL(columnsMoved(QModelIndex,int,int,QModelIndex,int)),
+                SLOT(proxySectionsMoved(QModelIndex,int,int,QModelIndex,int)));
+        connect(proxy, SIGNAL(rowsInserted(QModelIndex,int,int)), SLOT(proxyItemsChanged()));
+        connect(proxy, SIGNAL(rowsRemoved(QModelIndex,int,int)), SLOT(proxyItemsChanged()));
+        connect(source, SIGNAL(columnsAboutToBeInserted(QModelIndex,int,int)),
+                SLOT(sourceSectionsInserted(QModelIndex,int,int)));
+        connect(source, SIGNAL(columnsAboutToBeRemoved(QModelIndex,int,int)),
+                SLOT(sourceSectionsRemoved(QModelIndex,int,int)));
+        connect(source, SIGNAL(columnsAboutToBeMoved(QModelIndex,int,int,QModelIndex,int)),
+                SLOT(sourceSectionsMoved(QModelIndex,int,int,QModelIndex,int)));
+    }
+    else
+    {
+        connect(proxy, SIGNAL(rowsInserted(QModelIndex,int,int)), SLOT(proxySectionsInserted(QModelIndex,int,int)));
+        connect(proxy, SIGNAL(rowsRemoved(QModelIndex,int,int)), SLOT(proxySectionsRemoved(QModelIndex,int,int)));
+        connect(proxy, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)),
+                SLOT(proxySectionsMoved(QModelIndex,int,int,QModelIndex,int)));
+        connect(proxy, SIGNAL(columnsInserted(QModelIndex,int,int)), SLOT(proxyItemsChanged()));
+        connect(proxy, SIGNAL(columnsRemoved(QModelIndex,int,int)), SLOT(proxyItemsChanged()));
+        connect(source, SIGNAL(rowsAboutToBeInserted(QModelIndex,int,int)),
+                SLOT(sourceSectionsInserted(QModelIndex,int,int)));
+        connect(source, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
+                SLOT(sourceSectionsRemoved(QModelIndex,int,int)));
+        connect(source, SIGNAL(rowsAboutToBeMoved(QModelIndex,int,int,QModelIndex,int)),
+                SLOT(sourceSectionsMoved(QModelIndex,int,int,QModelIndex,int)));
+    }
+    connect(proxy, SIGNAL(layoutChanged(QList<QPersistentModelIndex>,QAbstractItemModel::LayoutChangeHint)),
+            SLOT(proxyLayoutChanged(QList<QPersistentModelIndex>,QAbstractItemModel::LayoutChangeHint)));
+    connect(proxy, SIGNAL(modelReset()), SLOT(proxyReset()));
+    connect(source, SIGNAL(headerSpanChanged(Qt::Orientation,int,int)),
+            SLOT(sourceSpansChanged(Qt::Orientation,int,int)));
+    rebuild(false);
+}
+//   CHeaderModel,    -
+CHeaderModel *CHeaderProxyAdapter::findHeaderSource(QAbstractItemModel *model)
+{
+    while (model)
+    {
+        CHeaderModel *cmodel = dynamic_cast<CHeaderModel *>(model);
+        if (cmodel)
+            return cmodel;
+        QAbstractProxyModel *proxyModel = qobject_cast<QAbstractProxyModel *>(model);
+        model = proxyModel? proxyModel->sourceModel() : 0;
+    }
+    return 0;
+}
+
+CHeaderModel *CHeaderProxyAdapter::headerSource() const
+{
+    return source;
+}
+
+int CHeaderProxyAdapter::mapSectionToSource(int section) const
+{
+    return section >= 0 && section < toSource.size()? toSource.at(section) : -1;
+}
+
+int CHeaderProxyAdapter::mapSectionFromSource(int section) const
+{
+    return section >= 0 && section < fromSource.size()? fromSource.at(section) : -1;
+}
+
+int CHeaderProxyAdapter::rowCount(const QModelIndex &parent) const
+{
+    return proxy && !parent.isValid()? proxy->rowCount() : 0;
+}
+
+int CHeaderProxyAdapter::columnCount(const QModelIndex &parent) const
+{
+    return proxy && !parent.isValid()? proxy->columnCount() : 0;
+}
+
+QVariant CHeaderProxyAdapter::data(const QModelIndex &index, int role) const
+{
+    if (!proxy || !index.isValid())
+        return QVariant();
+    return proxy->data(proxy->index(index.row(), index.column()), role);
+}
+
+int CHeaderProxyAdapter::headerCount(Qt::Orientation orientation) const
+{
+    return source && orientation == headerOrientation? source->headerCount(orientation) : 0;
+}
+//          .
+//        
+uint CHeaderProxyAdapter::headerContentHash(Qt::Orientation orientation) const
+{
+    uint hash = source && orientation == headerOrientation? source->headerContentHash(orientation) : 0;
+    if (!hash)
+        return 0;
+    return qHash(toSource, qHash(hash, headerShapeHash(orientation))) | 1;
+}
+//         
+QModelIndex CHeaderProxyAdapter::sourceCell(const QModelIndex &index) const
+{
+    int section = mapSectionToSource(index.column());
+    if (!source || section < 0)
+        return QModelIndex();
+    return source->headerIndex(headerOrientation, index.row(), section);
+}
+
+QVariant CHeaderProxyAdapter::headerDataInternal(const QModelIndex &index, Qt::Orientation orientation, int role) const
+{
+    if (orientation != headerOrientation)
+        return QVariant();
+    QModelIndex cell = sourceCell(index);
+    return cell.isValid()? source->headerData(cell, orientation, role) : QVariant();
+}
+
+void CHeaderProxyAdapter::headerMultiDataInternal(const QModelIndex &index, Qt::Orientation orientation,
+                                                  HeaderRoleData *roleData, int count) const
+{
+    QModelIndex cell = orientation == headerOrientation? sourceCell(index) : QModelIndex();
+    if (cell.isValid())
+        source->headerMultiData(cell, orientation, roleData, count);
+    else
+        for (int i = 0; i < count; ++i)
+            roleData[i].data = QVariant();
+}
+//  ,     -:  
+//        . 
+//    ,      
+void CHeaderProxyAdapter::proxySectionsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid() || !proxy || !source)
+        return;
+
+    int count = last-first+1;
+    for (int i = 0; i < fromSource.size(); ++i)
+        if (fromSource.at(i) >= first)
+            fromSource[i] += count;
+    toSource.insert(first, count, -1);
+    for (int section = first; mappedByItems && section <= last; ++section)
+    {
+        int sourceSection = mapSection(section);
+        if (sourceSection < 0 || sourceSection >= fromSource.size())
+            continue;
+        toSource[section] = sourceSection;
+        fromSource[sourceSection] = section;
+    }
+
+    headerInsertSections(headerOrientation, first, count);
+    updateSpans(first, last, false);
+}
+
+void CHeaderProxyAdapter::proxySectionsRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid() || !proxy || !source)
+        return;
+
+    int count = last-first+1;
+    for (int section = first; section <= last && section < toSource.size(); ++section)
+        if (toSource.at(section) >= 0 && toSource.at(section) < fromSource.size() &&
+            fromSource.at(toSource.at(section)) == section)
+            fromSource[toSource.at(section)] = -1;
+    for (int i = 0; i < fromSource.size(); ++i)
+        if (fromSource.at(i) > last)
+            fromSource[i] -= count;
+    toSource.remove(first, qMin(count, toSource.size()-first));
+
+    //           
+    headerRemoveSections(headerOrientation, first, last);
+    updateSpans(first-1, first, false);
+}
+
+void CHeaderProxyAdapter::proxySectionsMoved(const QModelIndex &parent, int start, int end,
+                                             const QModelIndex &destination, int section)
+{
+    if (parent.isValid() || destination.isValid() || !proxy || !source)
+        return;
+
+    int count    = end-start+1,
+        newStart = section > end? section-count : section;
+    if (newStart == start)
+        return;
+    QVector<int> block = toSource.mid(start, count);
+    toSource.remove(start, count);
+    toSource.insert(newStart, count, -1);
+    std::copy(block.constBegin(), block.constEnd(), toSource.begin()+newStart);
+
+    //          
+    int first = qMin(start, newStart),
+        last  = qMax(end, newStart+count-1);
+    for (int i = first; i <= last; ++i)
+        if (toSource.at(i) >= 0 && toSource.at(i) < fromSource.size())
+            fromSource[toSource.at(i)] = i;
+
+    headerMoveSections(headerOrientation, start, end, section);
+    updateSpans(first-1, last+1, false);
+}
+//     ,    
+// -:      ,  -
+//    -
+void CHeaderProxyAdapter::sourceSectionsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid())
+        return;
+
+    int count = last-first+1;
+    for (int i = 0; i < toSource.size(); ++i)
+        if (toSource.at(i) >= first)
+            toSource[i] += count;
+    fromSource.insert(qMin(first, fromSource.size()), count, -1);
+}
+
+void CHeaderProxyAdapter::sourceSectionsRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid())
+        return;
+
+    int count = last-first+1;
+    for (int i = 0; i < toSource.size(); ++i)
+    {
+        int sourceSection = toSource.at(i);
+        if (sourceSection > last)
+            toSource[i] = sourceSection-count;
+        else if (sourceSection >= first)
+            toSource[i] = -1;
+    }
+    if (first < fromSource.size())
+        fromSource.remove(first, qMin(count, fromSource.size()-first));
+}
+
+void CHeaderProxyAdapter::sourceSectionsMoved(const QModelIndex &parent, int start, int end,
+                                              const QModelIndex &destination, int section)
+{
+    if (parent.isValid() || destination.isValid())
+        return;
+
+    int count    = end-start+1,
+        newStart = section > end? section-count : section;
+    if (newStart == start)
+        return;
+    for (int i = 0; i < toSource.size(); ++i)
+    {
+        int sourceSection = toSource.at(i);
+        if (sourceSection < 0)
+            continue;
+        if (sourceSection >= start && sourceSection <= end)
+            sourceSection += newStart-start;
+        else
+        {
+            if (sourceSection > end)
+                sourceSection -= count;
+            if (sourceSection >= newStart)
+                sourceSection += count;
+        }
+        toSource[i] = sourceSection;
+    }
+    fromSource.fill(-1);
+    for (int i = 0; i < toSource.size(); ++i)
+        if (toSource.at(i) >= 0 && toSource.at(i) < fromSource.size())
+            fromSource[toSource.at(i)] = i;
+}
+//  -:      
+void CHeaderProxyAdapter::proxyReset()
+{
+    rebuild(false);
+}
+//       
+void CHeaderProxyAdapter::proxyLayoutChanged(const QList<QPersistentModelIndex> &parents,
+                                             QAbstractItemModel::LayoutChangeHint hint)
+{
+    Q_UNUSED(parents);
+    if ((headerOrientation == Qt::Horizontal && hint == QAbstractItemModel::VerticalSortHint) ||
+        (headerOrientation == Qt::Vertical && hint == QAbstractItemModel::HorizontalSortHint))
+        return;
+    rebuild(false);
+}
+//      -,    
+//         
+void CHeaderProxyAdapter::proxyItemsChanged()
+{
+    if (!proxy)
+        return;
+    int items = headerOrientation == Qt::Horizontal? proxy->rowCount() : proxy->columnCount();
+    if ((items > 0) == mappedByItems)
+        return;
+
+    rebuild(true);
+    int sections = toSource.size();
+    if (sections > 0)
+        emit headerDataChanged(headerOrientation, 0, sections-1);
+}
+//     :   
+//    -,      
+void CHeaderProxyAdapter::sourceSpansChanged(Qt::Orientation orientation, int first, int last)
+{
+    if (orientation != headerOrientation)
+        return;
+
+    int proxyFirst = toSource.size(),
+        proxyLast  = -1;
+    for (int i = qMax(first, 0); i <= last && i < fromSource.size(); ++i)
+        if (fromSource.at(i) >= 0)
+        {
+            proxyFirst = qMin(proxyFirst, fromSource.at(i));
+            proxyLast  = qMax(proxyLast, fromSource.at(i));
+        }
+    if (proxyFirst <= proxyLast)
+        updateSpans(proxyFirst, proxyLast, true);
+}
+
+void CHeaderProxyAdapter::rebuild(bool notify)
+{
+    rebuildMap();
+    rebuildSpans(notify);
+}
+//       -. -  
+//        ( 
+//   ),      
+void CHeaderProxyAdapter::rebuildMap()
+{
+    toSource.clear();
+    fromSource.clear();
+    mappedByItems = false;
+    if (!proxy || !source)
+        return;
+
+    bool horizontal = headerOrientation == Qt::Horizontal;
+    int sections = horizontal? proxy->columnCount() : proxy->rowCount(),
+        sourceSections = horizontal? source->columnCount() : source->rowCount(),
+        items = horizontal? proxy->rowCount() : proxy->columnCount();
+
+    toSource.fill(-1, sections);
+    fromSource.fill(-1, sourceSections);
+    mappedByItems = items > 0;
+    if (!mappedByItems)
+        return;
+    for (int section = 0; section < sections; ++section)
+    {
+        int sourceSection = mapSection(section);
+        if (sourceSection < 0 || sourceSection >= sourceSections)
+            continue;
+        toSource[section] = sourceSection;
+        fromSource[sourceSection] = section;
+    }
+}
+//    -   :   
+//     -  mapToSource.
+//  -1,    
+int CHeaderProxyAdapter::mapSection(int section) const
+{
+    bool horizontal = headerOrientation == Qt::Horizontal;
+    QModelIndex index = horizontal? proxy->index(0, section) : proxy->index(section, 0);
+    QAbstractItemModel *model = proxy;
+    while (index.isValid() && model != source)
+    {
+        QAbstractProxyModel *proxyModel = qobject_cast<QAbstractProxyModel *>(model);
+        if (!proxyModel)
+            return -1;
+        index = proxyModel->mapToSource(index);
+        model = proxyModel->sourceModel();
+    }
+    return index.isValid() && model == source? (horizontal? index.column() : index.row()) : -1;
+}
+//        -
+void CHeaderProxyAdapter::rebuildSpans(bool notify)
+{
+    bool blocked = notify? signalsBlocked() : blockSignals(true);
+    headerSetSpans(headerOrientation, collectSpans(0, toSource.size()-1));
+    blockSignals(blocked);
+}
+//       first-last.  
+//           
+//  ,  ,     
+void CHeaderProxyAdapter::updateSpans(int first, int last, bool notify)
+{
+    int levels   = headerCount(headerOrientation),
+        sections = toSource.size();
+    first = qMax(first, 0);
+    last  = qMin(last, sections-1);
+    if (!source || first > last)
+        return;
+
+    bool extended = true;
+    while (extended)
+    {
+        extended = false;
+        for (int row = 0; row < levels; ++row)
+        {
+            int from = first,
+                to   = last;
+            QModelIndex cell = headerIndex(headerOrientation, row, first);
+            if (cell.isValid())
+                from = qMin(from, cell.column());
+            cell = headerIndex(headerOrientation, row, last);
+            if (cell.isValid())
+                to = qMax(to, cell.column()+headerData(cell, headerOrientation, SectionSpanRole).toInt()-1);
+            while (from > 0 && sameSourceCell(row, from-1, from))
+                --from;
+            while (to < sections-1 && sameSourceCell(row, to, to+1))
+                ++to;
+            if (from < first || to > last)
+            {
+                first    = from;
+                last     = qMin(to, sections-1);
+                extended = true;
+            }
+        }
+    }
+
+    bool blocked = notify? signalsBlocked() : blockSignals(true);
+    headerReplaceSpans(headerOrientation, first, last, collectSpans(first, last));
+    blockSignals(blocked);
+}
+//  ,   -     
+//     
+bool CHeaderProxyAdapter::sameSourceCell(int row, int section, int other) const
+{
+    int sourceSection = toSource.at(section),
+        sourceOther   = toSource.at(other);
+    if (sourceSection < 0 || sourceOther < 0)
+        return false;
+    return source->headerIndex(headerOrientation, row, sourceSection) ==
+           source->headerIndex(headerOrientation, row, sourceOther);
+}
+//     first-last    :
+//    -      
+// . ,    ,  
+//     
+QVector<CHeaderModel::HeaderSpan> CHeaderProxyAdapter::collectSpans(int first, int last) const
+{
+    QVector<HeaderSpan> spans;
+    int levels = headerCount(headerOrientation);
+    for (int row = 0; row < levels; ++row)
+    {
+        int section = first;
+        while (section <= last)
+        {
+            QModelIndex cell = toSource.at(section) < 0? QModelIndex() :
+                               source->headerIndex(headerOrientation, row, toSource.at(section));
+            int next = section+1;
+            while (next <= last && cell.isValid() && toSource.at(next) >= 0 &&
+                   source->headerIndex(headerOrientation, row, toSource.at(next)) == cell)
+                ++next;
+
+            // ,     ,   
+            if (cell.isValid() && cell.row() == row)
+            {
+                QVariant levelSpan = source->headerData(cell, headerOrientation, LevelSpanRole);
+                HeaderSpan span;
+                span.row             = row;
+                span.column          = section;
+                span.rowSpanCount    = levelSpan.canConvert<uint>()? qMax(1, levelSpan.toInt()) : 1;
+                span.columnSpanCount = next-section;
+                if (span.rowSpanCount > 1 || span.columnSpanCount > 1)
+                    spans.append(span);
+            }
+            section = next;
+        }
+    }
+    return spans;
+}
+
+
+// CHeaderStringModel -        
+
+// .  0  -  
+CHeaderStringModel::CHeaderStringModel(Qt::Orientation orientation, QObject *parent):
+    CHeaderModel(parent), headerOrientation(orientation), levelCount(0), sectionCount(0), items(0),
+    mappedFile(0)
+{
+    strings.append(QString());
+}
+
+CHeaderStringModel::~CHeaderStringModel()
+{
+    closeFile();
+}
+//       ,    
+void CHeaderStringModel::setHeaderSize(int levels, int sections)
+{
+    beginResetModel();
+    closeFile();
+    levelCount   = qMax(0, levels);
+    sectionCount = qMax(0, sections);
+    strings.clear();
+    strings.append(QString());
+    stringIds.clear();
+    ownIndex.clear();
+    ownIndex.resize(levelCount);
+    levelIndex.resize(levelCount);
+    for (int level = 0; level < levelCount; ++level)
+    {
+        ownIndex[level].fill(0, sectionCount);
+        levelIndex[level] = ownIndex.at(level).constData();
+    }
+    headerResetSpans(headerOrientation);
+    endResetModel();
+}
+
+void CHeaderStringModel::setHeaderLabel(int level, int section, const QString &label)
+{
+    if (level < 0 || level >= levelCount || section < 0 || section >= sectionCount)
+        return;
+
+    quint32 id = stringId(label);
+    if (levelIndex.at(level)[section] == id)
+        return;
+    detachIndex(level);
+    ownIndex[level][section] = id;
+    levelIndex[level] = ownIndex.at(level).constData();
+    emit headerDataChanged(headerOrientation, section, section);
+}
+
+QString CHeaderStringModel::headerLabel(int level, int section) const
+{
+    if (level < 0 || level >= levelCount || section < 0 || section >= sectionCount)
+        return QString();
+    return strings.at(levelIndex.at(level)[section]);
+}
+//        (    )
+void CHeaderStringModel::setHeaderLabels(int level, int first, const QStringList &labels)
+{
+    if (level < 0 || level >= levelCount || first < 0 || first >= sectionCount || labels.isEmpty())
+        return;
+
+    int last = qMin(sectionCount, first+labels.size())-1;
+    detachIndex(level);
+    QVector<quint32> &index = ownIndex[level];
+    for (int section = first; section <= last; ++section)
+        index[section] = stringId(labels.at(section-first));
+    levelIndex[level] = index.constData();
+    emit headerDataChanged(headerOrientation, first, last);
+}
+
+void CHeaderStringModel::setItemCount(int count)
+{
+    count = qMax(0, count);
+    if (count == items)
+        return;
+    beginResetModel();
+    items = count;
+    endResetModel();
+}
+
+int CHeaderStringModel::itemCount() const
+{
+    return items;
+}
+
+int CHeaderStringModel::stringCount() const
+{
+    return strings.size();
+}
+//       ,   .
+//         
+quint32 CHeaderStringModel::stringId(const QString &label)
+{
+    if (label.isEmpty())
+        return 0;
+    if (stringIds.isEmpty())
+        for (int i = 1; i < strings.size(); ++i)
+            stringIds.insert(strings.at(i), i);
+
+    QHash<QString,quint32>::const_iterator it = stringIds.constFind(label);
+    if (it != stringIds.constEnd())
+        return it.value();
+    quint32 id = strings.size();
+    strings.append(label);
+    stringIds.insert(label, id);
+    return id;
+}
+//           
+void CHeaderStringModel::detachIndex(int level)
+{
+    if (ownIndex.at(level).size() == sectionCount)
+        return;
+    QVector<quint32> index(sectionCount);
+    std::copy(levelIndex.at(level), levelIndex.at(level)+sectionCount, index.begin());
+    ownIndex[level] = index;
+    levelIndex[level] = ownIndex.at(level).constData();
+}
+
+void CHeaderStringModel::closeFile()
+{
+    delete mappedFile;
+    mappedFile = 0;
+}
+//         (  )
+bool CHeaderStringModel::saveHeaderFile(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    QVector<quint32> offsets;
+    offsets.reserve(strings.size()+1);
+    quint32 characters = 0;
+    for (int i = 0; i < strings.size(); ++i)
+    {
+        offsets.append(characters);
+        characters += strings.at(i).size();
+    }
+    offsets.append(characters);
+    QByteArray spans = headerSaveSpans(headerOrientation);
+
+    FileHeader header;
+    header.magic      = FileMagic;
+    header.version    = FileVersion;
+    header.levels     = levelCount;
+    header.sections   = sectionCount;
+    header.strings    = strings.size();
+    header.characters = characters;
+    header.spansSize  = spans.size();
+    header.reserved   = 0;
+
+    bool ok = file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == qint64(sizeof(header));
+    qint64 size = offsets.size()*sizeof(quint32);
+    ok = ok && file.write(reinterpret_cast<const char *>(offsets.constData()), size) == size;
+    size = sectionCount*sizeof(quint32);
+    for (int level = 0; ok && level < levelCount; ++level)
+        ok = file.write(reinterpret_cast<const char *>(levelIndex.at(level)), size) == size;
+    for (int i = 0; ok && i < strings.size(); ++i)
+    {
+        size = strings.at(i).size()*sizeof(QChar);
+        ok = file.write(reinterpret_cast<const char *>(strings.at(i).constData()), size) == size;
+    }
+    ok = ok && file.write(spans) == spans.size();
+    return ok;
+}
+//     ,  saveHeaderFile.  
+//  :        ,  
+//      .      
+bool CHeaderStringModel::loadHeaderFile(const QString &fileName)
+{
+    QFile *file = new QFile(fileName);
+    uchar *data = 0;
+    if (file->open(QIODevice::ReadOnly) && file->size() >= qint64(sizeof(FileHeader)))
+        data = file->map(0, file->size());
+    if (!data)
+    {
+        delete file;
+        return false;
+    }
+
+    //          ,
+    //      
+    const FileHeader *header = reinterpret_cast<const FileHeader *>(data);
+    qint64 rest  = file->size()-qint64(sizeof(FileHeader)),
+           cells = qint64(header->levels)*header->sections;
+    bool valid = header->magic == quint32(FileMagic) && header->version == quint32(FileVersion) &&
+                 header->strings > 0 && header->levels <= 0x7fffffff && header->sections <= 0x7fffffff &&
+                 header->strings < rest/qint64(sizeof(quint32));
+    if (valid)
+        rest -= (qint64(header->strings)+1)*qint64(sizeof(quint32));
+    valid = valid && cells <= rest/qint64(sizeof(quint32));
+    if (valid)
+        rest -= cells*qint64(sizeof(quint32));
+    valid = valid && header->characters <= rest/qint64(sizeof(QChar));
+    if (valid)
+        rest -= qint64(header->characters)*qint64(sizeof(QChar));
+    valid = valid && qint64(header->spansSize) == rest;
+
+    const quint32 *offsets = reinterpret_cast<const quint32 *>(data+sizeof(FileHeader)),
+                  *index   = valid? offsets+header->strings+1 : 0;
+    const QChar   *chars   = valid? reinterpret_cast<const QChar *>(index+cells) : 0;
+    //          ,  0 ,
+    //       
+    valid = valid && offsets[0] == 0 && offsets[1] == 0 && offsets[header->strings] == header->characters;
+    for (quint32 i = 1; valid && i < header->strings; ++i)
+        valid = offsets[i] <= offsets[i+1] && offsets[i+1] <= header->characters;
+    for (qint64 i = 0; valid && i < cells; ++i)
+        valid = index[i] < header->strings;
+    //     
+    QByteArray spans;
+    if (valid)
+        spans = QByteArray(reinterpret_cast<const char *>(chars+header->characters), header->spansSize);
+    valid = valid && (spans.isEmpty() || checkSpans(spans, int(header->levels), int(header->sections)));
+    if (!valid)
+    {
+        delete file;
+        return false;
+    }
+
+    QVector<QString> table;
+    table.reserve(header->strings);
+    for (quint32 i = 0; i < header->strings; ++i)
+        table.append(QString(chars+offsets[i], offsets[i+1]-offsets[i]));
+
+    beginResetModel();
+    closeFile();
+    mappedFile   = file;
+    levelCount   = header->levels;
+    sectionCount = header->sections;
+    strings.swap(table);
+    stringIds.clear();
+    ownIndex.clear();
+    ownIndex.resize(levelCount);
+    levelIndex.resize(levelCount);
+    for (int level = 0; level < levelCount; ++level)
+        levelIndex[level] = index+qint64(level)*sectionCount;
+    //         
+    headerResetSpans(headerOrientation, spans);
+    endResetModel();
+    return true;
+}
+
+int CHeaderStringModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return headerOrientation == Qt::Horizontal? items : sectionCount;
+}
+
+int CHeaderStringModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return headerOrientation == Qt::Horizontal? sectionCount : items;
+}
+
+QVariant CHeaderStringModel::data(const QModelIndex &index, int role) const
+{
+    Q_UNUSED(index);
+    Q_UNUSED(role);
+    return QVariant();
+}
+
+//  :         .
+//    ,      
+uint CHeaderStringModel::headerContentHash(Qt::Orientation orientation) const
+{
+    uint hash = headerShapeHash(orientation);
+    if (orientation != headerOrientation)
+        return hash | 1;
+
+    for (int i = 0; i < strings.size(); ++i)
+        hash = qHash(strings.at(i), hash);
+    for (int level = 0; level < levelIndex.size(); ++level)
+        hash = qHashBits(levelIndex.at(level), sectionCount*sizeof(quint32), hash);
+    return hash | 1;
+}
+
+int CHeaderStringModel::headerCount(Qt::Orientation orientation) const
+{
+    return orientation == headerOrientation? levelCount : 0;
+}
+//        
+QVariant CHeaderStringModel::headerDataInternal(const QModelIndex &index, Qt::Orientation orientation, int role) const
+{
+    if (orientation != headerOrientation || role != Qt::DisplayRole ||
+        index.row() >= levelCount || index.column() >= sectionCount)
+        return QVariant();
+    quint32 id = levelIndex.at(index.row())[index.column()];
+    return id? QVariant(strings.at(id)) : QVariant();
+}
+
+void CHeaderStringModel::headerMultiDataInternal(const QModelIndex &index, Qt::Orientation orientation,
+                                                 HeaderRoleData *roleData, int count) const
+{
+    for (int i = 0; i < count; ++i)
+        roleData[i].data = roleData[i].role == Qt::DisplayRole?
+                           headerDataInternal(index, orientation, Qt::DisplayRole) : QVariant();
+}
+
+
+// CHeaderView  -      
+
+//     
+CHeaderView::CHeaderView(Qt::Orientation orientation, QWidget *parent):
+    QHeaderView(orientation,parent), proxyAdapter(0), levelCount(0), cellCache(0), lazySizingMode(false), lazyMargin(100),
+    sharedLayout(new SharedLayout), layoutRevision(0),
+    progressiveMode(false), progressiveSlice(10), progressiveNext(0), progressiveSlices(0),
+    parallelSizingMode(false), hoverMode(false), hoverRow(-1), hoverColumn(-1), hoverTracking(false),
+    highlightRow(-1), highlightColumn(-1), searchValid(false), pinningMode(false), paintedOffset(0),
+    selectionDirty(true), statisticsMode(false), exportMode(false)
+{
+    setSectionsMovable(false);
+}
+
+//     :  CHeaderModel ,  -
+//  CHeaderModel, ,     -
+void CHeaderView::setModel(QAbstractItemModel *model)
+{
+    if (headerModel)
+        disconnect(headerModel, 0, this, SLOT(headerSpansChanged(Qt::Orientation,int,int)));
+    if (this->model())
+    {
+        disconnect(this->model(), 0, this, SLOT(headerCellsChanged(Qt::Orientation,int,int)));
+        disconnect(this->model(), 0, this, SLOT(headerLayoutChanged(QList<QPersistentModelIndex>,QAbstractItemModel::LayoutChangeHint)));
+        disconnect(this->model(), 0, this, SLOT(headerSectionsInserted(QModelIndex,int,int)));
+        disconnect(this->model(), 0, this, SLOT(headerSectionsRemoved(QModelIndex,int,int)));
+        disconnect(this->model(), 0, this, SLOT(headerSectionsMoved(QModelIndex,int,int,QModelIndex,int)));
+        disconnect(this->model(), 0, this, SLOT(invalidateSelection()));
+    }
+
+    //    QHeaderView::setModel,   
+    // -  
+    delete proxyAdapter;
+    proxyAdapter = 0;
+    headerModel  = dynamic_cast<CHeaderModel *>(model);
+    if (!headerModel)
+    {
+        CHeaderModel *source = CHeaderProxyAdapter::findHeaderSource(model);
+        if (source)
+        {
+            proxyAdapter = new CHeaderProxyAdapter(orientation(), model, source, this);
+            headerModel  = proxyAdapter;
+        }
+    }
+
+    QHeaderView::setModel(model);
+
+    if (model)
+    {
+        connect(model, SIGNAL(headerDataChanged(Qt::Orientation,int,int)),
+                this, SLOT(headerCellsChanged(Qt::Orientation,int,int)));
+        if (headerModel)
+            connect(headerModel, SIGNAL(headerSpanChanged(Qt::Orientation,int,int)),
+                    this, SLOT(headerSpansChanged(Qt::Orientation,int,int)));
+        if (proxyAdapter)
+        {
+            connect(proxyAdapter, SIGNAL(headerDataChanged(Qt::Orientation,int,int)),
+                    this, SLOT(headerCellsChanged(Qt::Orientation,int,int)));
+            connect(model, SIGNAL(layoutChanged(QList<QPersistentModelIndex>,QAbstractItemModel::LayoutChangeHint)),
+                    this, SLOT(headerLayoutChanged(QList<QPersistentModelIndex>,QAbstractItemModel::LayoutChangeHint)));
+        }
+        if (orientation() == Qt::Horizontal)
+        {
+            connect(model, SIGNAL(columnsInserted(QModelIndex,int,int)),
+                    this, SLOT(headerSectionsInserted(QModelIndex,int,int)));
+            connect(model, SIGNAL(columnsRemoved(QModelIndex,int,int)),
+                    this, SLOT(headerSectionsRemoved(QModelIndex,int,int)));
+            connect(model, SIGNAL(columnsMoved(QModelIndex,int,int,QModelIndex,int)),
+                    this, SLOT(headerSectionsMoved(QModelIndex,int,int,QModelIndex,int)));
+            connect(model, SIGNAL(rowsInserted(QModelIndex,int,int)), this, SLOT(invalidateSelection()));
+            connect(model, SIGNAL(rowsRemoved(QModelIndex,int,int)), this, SLOT(invalidateSelection()));
+        }
+        else
+        {
+            connect(model, SIGNAL(rowsInserted(QModelIndex,int,int)),
+                    this, SLOT(headerSectionsInserted(QModelIndex,int,int)));
+            connect(model, SIGNAL(rowsRemoved(QModelIndex,int,int)),
+                    this, SLOT(headerSectionsRemoved(QModelIndex,int,int)));
+            connect(model, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)),
+                    this, SLOT(headerSectionsMoved(QModelIndex,int,int,QModelIndex,int)));
+            connect(model, SIGNAL(columnsInserted(QModelIndex,int,int)), this, SLOT(invalidateSelection()));
+            connect(model, SIGNAL(columnsRemoved(QModelIndex,int,int)), this, SLOT(invalidateSelection()));
+        }
+        connect(model, SIGNAL(layoutChanged()), this, SLOT(invalidateSelection()));
+    }
+
+    invalidateLayout();
+    cellCache.clear();
+    invalidateSelection();
+    hoverRow        = -1;
+    hoverColumn     = -1;
+    highlightRow    = -1;
+    highlightColumn = -1;
+    clearSearchIndex();
+    initializeSections();
+}
+
+//       , 
+// ,        
+// (   ).   
+//  ,      
+void CHeaderView::setSelectionModel(QItemSelectionModel *selectionModel)
+{
+    if (this->selectionModel()) {
+        disconnect(this->selectionModel(), SIGNAL(selectionChanged(QItemSelection,QItemSelection)),
+                   this, SLOT(headerSelectionChanged(QItemSelection,QItemSelection)));
+    }
+
+    QHeaderView::setSelectionModel(selectionModel);
+
+    if (selectionModel) {
+        connect(selectionModel, SIGNAL(selectionChanged(QItemSelection,QItemSelection)),
+                this, SLOT(headerSelectionChanged(QItemSelection,QItemSelection)));
+    }
+    invalidateSelection();
+    viewport()->update();
+}
+
+//       .
+//    ,      
+void CHeaderView::setCellCacheLimit(int kbytes)
+{
+    cellCache.setMaxCost(qMax(0, kbytes));
+    viewport()->update();
+}
+
+int CHeaderView::cellCacheLimit() const
+{
+    return cellCache.maxCost();
+}
+//   :     
+//  lazySizingMargin()   ,   
+//    ,     estimatedCellSize()
+void CHeaderView::setLazySizing(bool enabled)
+{
+    if (lazySizingMode == enabled)
+        return;
+    lazySizingMode = enabled;
+    invalidateLayout();
+    scheduleDelayedItemsLayout();
+}
+
+bool CHeaderView::lazySizing() const
+{
+    return lazySizingMode;
+}
+//        ,  
+void CHeaderView::setLazySizingMargin(int sections)
+{
+    lazyMargin = qMax(0, sections);
+}
+
+int CHeaderView::lazySizingMargin() const
+{
+    return lazyMargin;
+}
+//    .   ( )
+// ,        ,
+//        defaultSectionSize()
+void CHeaderView::setEstimatedCellSize(const QSize &size)
+{
+    if (cellSizeEstimate == size)
+        return;
+    cellSizeEstimate = size;
+    if (deferredSizing())
+    {
+        invalidateLayout();
+        scheduleDelayedItemsLayout();
+    }
+}
+
+QSize CHeaderView::estimatedCellSize() const
+{
+    return cellSizeEstimate;
+}
+//   :       
+//     ,      
+//   .      QCommonStyle,
+//       CT_HeaderSection   
+void CHeaderView::setParallelSizing(bool enabled)
+{
+    // ,       ,  
+    if (parallelSizingMode != enabled)
+        sharedLayout->measureCache.clear();
+    parallelSizingMode = enabled;
+}
+
+bool CHeaderView::parallelSizing() const
+{
+    return parallelSizingMode;
+}
+//   :       
+//   lazySizingMargin()    (   
+// estimatedCellSize()),       
+//   progressiveSliceTime() .    
+// ,     layoutCompleted()
+void CHeaderView::setProgressiveLayout(bool enabled)
+{
+    if (progressiveMode == enabled)
+        return;
+    progressiveMode = enabled;
+    invalidateLayout();
+    scheduleDelayedItemsLayout();
+}
+
+bool CHeaderView::progressiveLayout() const
+{
+    return progressiveMode;
+}
+//       
+void CHeaderView::setProgressiveSliceTime(int msecs)
+{
+    progressiveSlice = qMax(1, msecs);
+}
+
+int CHeaderView::progressiveSliceTime() const
+{
+    return progressiveSlice;
+}
+//   true,          
+// (        )
+bool CHeaderView::isLayoutComplete() const
+{
+    return layoutMatchesModel(modelSectionCount()) && !progressiveTimer.isActive();
+}
+//   true,        
+bool CHeaderView::deferredSizing() const
+{
+    return lazySizingMode || progressiveMode;
+}
+//   true,         
+bool CHeaderView::layoutMatchesModel(int sections) const
+{
+    return !sharedLayout->levels.isEmpty() && sharedLayout->levels.size() == levelCount &&
+           sharedLayout->levels.at(0).cellSize.size() == sections;
+}
+
+void CHeaderView::doItemsLayout()
+{
+    initializeSections();
+    QHeaderView::doItemsLayout();
+}
+
+//        
+void CHeaderView::reset()
+{
+    invalidateLayout();
+    cellCache.clear();
+    invalidateSelection();
+    clearSearchIndex();
+    initializeSections();
+    QHeaderView::reset();
+}
+
+
+//      ( )
+//     QHeaderView::initializeSections().
+//          ,
+//        
+void CHeaderView::initializeSections()
+{
+    //         
+    QElapsedTimer timer;
+    if (statisticsMode || lcHeaderView().isDebugEnabled())
+        timer.start();
+
+    bool completed = false,
+         updated   = false;
+    CHeaderModel *cmodel = headerModel.data();
+    if (cmodel)
+    {
+        int levels   = cmodel->headerCount(orientation()),
+            sections = modelSectionCount();
+
+        bool rebuild = sharedLayout->levels.size() != levels || levelCount != levels ||
+                       (levels > 0 && sharedLayout->levels.at(0).cellSize.size() != sections);
+        //  ,    ,  
+        if (rebuild && !pendingLayout.isEmpty())
+        {
+            QByteArray data;
+            data.swap(pendingLayout);
+            rebuild   = !applyLayout(cmodel, data);
+            completed = !rebuild;
+            updated   = completed;
+        }
+        //    ,   
+        if (rebuild && adoptLinkedLayout(levels, sections))
+        {
+            rebuild   = false;
+            completed = true;
+            updated   = true;
+        }
+
+        if (rebuild)
+        {
+            // ,    ,    
+            QExplicitlySharedDataPointer<SharedLayout> layout(new SharedLayout);
+            layout->measureCache = sharedLayout->measureCache;
+            layout->revision     = layoutRevision;
+            sharedLayout = layout;
+
+            updated    = true;
+            levelCount = levels;
+            sharedLayout->levels.resize(levelCount);
+            for (int row=0; row<levelCount; ++row)
+            {
+                LevelLayout &level = sharedLayout->levels[row];
+                level.cellSize.fill(QSize(), sections);
+                level.cellExtent.fill(0, sections);
+                level.size         = 0;
+                level.restoredSize = 0;
+            }
+            sectionHint.clear();
+
+            if (!deferredSizing() && parallelSizingMode)
+                measureCellsParallel(cmodel, 0, sections-1);
+
+            //             
+            if (!deferredSizing() || cellSizeEstimate.isValid())
+                for (int row=0; row<levelCount; ++row)
+                    updateLevelCells(cmodel, row, 0, sections-1);
+
+            if (deferredSizing() && sections > 0)
+            {
+                int extent = orientation() == Qt::Horizontal? viewport()->width() : viewport()->height(),
+                    first  = qBound(0, logicalIndexAt(0), sections-1),
+                    last   = logicalIndexAt(extent-1);
+                measureSections(first, last < 0? first : qMin(last, sections-1));
+            }
+
+            //       
+            if (progressiveMode)
+            {
+                progressiveNext   = 0;
+                progressiveSlices = 0;
+                progressiveTimer.start(0, this);
+            }
+            else
+                completed = !lazySizingMode;
+        }
+        updateLevelBottom();
+    }
+
+    QHeaderView::initializeSections();
+
+    if (timer.isValid())
+    {
+        qint64 elapsed = timer.nsecsElapsed();
+        if (statisticsMode)
+        {
+            ++stats.layoutRuns;
+            stats.layoutTime += elapsed;
+        }
+        qCDebug(lcHeaderView, "initializeSections: %d sections, %d levels, %.3f ms",
+                count(), levelCount, elapsed/1e6);
+    }
+    if (updated)
+        emit headerLayoutUpdated();
+    if (completed)
+        emit layoutCompleted();
+}
+//        
+// (count()   QHeaderView::initializeSections()   )
+int CHeaderView::modelSectionCount() const
+{
+    if (!model())
+        return 0;
+    return orientation() == Qt::Horizontal? model()->columnCount(rootIndex()) : model()->rowCount(rootIndex());
+}
+//      ,      
+QSize CHeaderView::cachedCellSize(const QModelIndex &index) const
+{
+    if (!index.isValid() || index.row() >= sharedLayout->levels.size() ||
+        index.column() >= sharedLayout->levels.at(index.row()).cellSize.size())
+        return cellSizeFromContents(index);
+
+    //      ,    
+    const QSize &cached = sharedLayout->levels.at(index.row()).cellSize.at(index.column());
+    if (statisticsMode)
+        ++(cached.isValid()? stats.sizeCacheHits : stats.sizeCacheMisses);
+    if (cached.isValid())
+        return cached;
+
+    QSize size = cellSizeFromContents(index);
+    sharedLayout->levels[index.row()].cellSize[index.column()] = size;
+    return size;
+}
+//      :  ,
+//       -  
+QSize CHeaderView::knownCellSize(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return QSize();
+    if (index.row() < sharedLayout->levels.size() &&
+        index.column() < sharedLayout->levels.at(index.row()).cellSize.size())
+    {
+        const QSize &size = sharedLayout->levels.at(index.row()).cellSize.at(index.column());
+        if (statisticsMode)
+            ++(size.isValid()? stats.sizeCacheHits : stats.sizeCacheMisses);
+        if (size.isValid())
+            return size;
+    }
+    return cellSizeEstimate;
+}
+//       lazyMargin   
+// (    ).    ,
+//       
+void CHeaderView::measureSections(int first, int last)
+{
+    CHeaderModel *cmodel = headerModel.data();
+    int sections = modelSectionCount();
+    if (!cmodel || !layoutMatchesModel(sections))
+        return;
+
+    bool resizePending = !pendingSections.isEmpty(),
+         changed       = false;
+    if (measureSectionRange(cmodel, qMax(0, first-lazyMargin), qMin(sections-1, last+lazyMargin), changed))
+        applyMeasuredSections(changed, resizePending);
+}
+//          ,
+// changed    .    
+// (. applyMeasuredSections).  true,       
+bool CHeaderView::measureSectionRange(CHeaderModel *cmodel, int first, int last, bool &changed)
+{
+    int sections = modelSectionCount();
+
+    //  ,    
+    int from = last+1,
+        to   = first-1;
+    for (int col = first; col <= last; ++col)
+    {
+        if (isSectionHidden(col))
+            continue;
+
+        bool measured = false;
+        for (int row = 0; row < levelCount; ++row)
+        {
+            QModelIndex index = cmodel->headerIndex(orientation(),row,col);
+            if (!index.isValid())
+                continue;
+
+            //      ,    
+            if (sharedLayout->levels.at(index.row()).cellSize.at(index.column()).isValid())
+                continue;
+            sharedLayout->levels[index.row()].cellSize[index.column()] = cellSizeFromContents(index);
+            measured = true;
+
+            int lastSection, lastLevel;
+            cellSpan(cmodel, index, lastSection, lastLevel);
+            from = qMin(from, index.column());
+            to   = qMax(to, qMin(lastSection, sections-1));
+        }
+
+        if (measured && sectionResizeMode(col) == QHeaderView::ResizeToContents)
+            pendingSections.append(col);
+    }
+
+    if (from > to)
+        return false;
+
+    for (int row = 0; row < levelCount; ++row)
+        changed |= updateLevelCells(cmodel, row, from, to);
+    return true;
+}
+//         :
+//       , 
+//  ResizeToContents   ,     
+void CHeaderView::applyMeasuredSections(bool changed, bool resizePending)
+{
+    if (changed && updateLevelBottom())
+    {
+        updateGeometry();
+        QMetaObject::invokeMethod(this, "geometriesChanged", Qt::QueuedConnection);
+    }
+    if (!resizePending && !pendingSections.isEmpty())
+        QMetaObject::invokeMethod(this, "resizePendingSections", Qt::QueuedConnection);
+    emit headerLayoutUpdated();
+}
+//       ResizeToContents,  
+//      
+void CHeaderView::resizePendingSections()
+{
+    QVector<int> sections;
+    sections.swap(pendingSections);
+    for (int i = 0; i < sections.size(); ++i)
+    {
+        int section = sections.at(i);
+        if (section < count() && sectionResizeMode(section) == QHeaderView::ResizeToContents)
+            resizeSection(section, sectionSizeHint(section));
+    }
+}
+//        :
+//      ,     ,
+//   (, ,  )    
+void CHeaderView::measureCellsParallel(CHeaderModel *cmodel, int first, int last)
+{
+    QStyleOptionHeader opt;
+    initStyleOption(&opt);
+    int margin   = style()->pixelMetric(QStyle::PM_HeaderMargin, &opt, this),
+        iconSize = style()->pixelMetric(QStyle::PM_SmallIconSize, &opt, this);
+
+    //       
+    QVector<CellContents> cells;
+    QHash<MeasureKey,int> pending;
+    for (int row = 0; row < levelCount; ++row)
+    {
+        const QVector<QSize> &sizes = sharedLayout->levels.at(row).cellSize;
+        for (int col = first; col <= last; ++col)
+        {
+            QModelIndex index = cmodel->headerIndex(orientation(),row,col);
+            if (!index.isValid() || index.row() != row || index.column() != col || sizes.at(col).isValid())
+                continue;
+
+            MeasureKey key;
+            QIcon icon;
+            QSize size;
+            // ,     ,   
+            if (!cellMeasureKey(cmodel, index, iconSize, key, icon, size) || !size.isEmpty())
+            {
+                sharedLayout->levels[row].cellSize[col] = size;
+                continue;
+            }
+
+            QHash<MeasureKey,int>::const_iterator it = pending.constFind(key);
+            if (it != pending.constEnd())
+            {
+                cells[it.value()].targets.append(QPoint(col, row));
+                continue;
+            }
+
+            CellContents cell;
+            cell.key = key;
+            cell.targets.append(QPoint(col, row));
+            pending.insert(key, cells.size());
+            cells.append(cell);
+        }
+    }
+
+    if (cells.size() < 256 || !QFontDatabase::supportsThreadedFontRendering())
+        for (int i = 0; i < cells.size(); ++i)
+            measureCellText(cells[i]);
+    else
+        QtConcurrent::blockingMap(cells, &CHeaderView::measureCellText);
+
+    for (int i = 0; i < cells.size(); ++i)
+    {
+        const CellContents &cell = cells.at(i);
+        bool hasIcon = cell.key.iconSize.isValid();
+        int  icon    = hasIcon? iconSize : 0;
+        QSize size((hasIcon? margin : 0) + icon + (cell.key.text.isNull()? 0 : margin) + cell.textSize.width() + margin,
+                   margin + qMax(icon, cell.textSize.height()) + margin);
+        size = adjustedCellSize(size, cell.key.rotated, margin);
+
+        sharedLayout->measureCache.insert(cell.key, size);
+        for (int j = 0; j < cell.targets.size(); ++j)
+            sharedLayout->levels[cell.targets.at(j).y()].cellSize[cell.targets.at(j).x()] = size;
+    }
+}
+//    ,    
+void CHeaderView::measureCellText(CellContents &cell)
+{
+    cell.textSize = QFontMetrics(cell.key.font).size(0, cell.key.text);
+}
+//           .
+//       ,   .
+//  true,    
+bool CHeaderView::updateLevelCells(CHeaderModel *cmodel, int row, int first, int last)
+{
+    LevelLayout &level = sharedLayout->levels[row];
+    int  oldSize = level.size;
+    bool rescan  = false;
+
+    for (int col = first; col <= last; ++col)
+    {
+        QModelIndex index = cmodel->headerIndex(orientation(),row,col);
+        int extent = 0;
+        QSize hint = index.isValid()? (deferredSizing()? knownCellSize(index) : cachedCellSize(index)) : QSize();
+        if (hint.isValid())
+        {
+            QVariant span = cmodel->headerData(index, orientation(), CHeaderModel::LevelSpanRole);
+            int cellspan  = span.canConvert<uint>()? qBound(1,span.value<int>(),levelCount-index.row()) : 1;
+            extent = (orientation() == Qt::Horizontal)? hint.height()/cellspan : hint.width()/cellspan;
+        }
+
+        int oldExtent = level.cellExtent.at(col);
+        level.cellExtent[col] = extent;
+        if (extent >= level.size)
+            level.size = extent;
+        else
+        if (oldExtent == level.size)
+            rescan = true;
+    }
+
+    if (rescan)
+    {
+        level.size = level.restoredSize;
+        for (int col = 0; col < level.cellExtent.size(); ++col)
+            level.size = qMax(level.size, level.cellExtent.at(col));
+    }
+    return level.size != oldSize;
+}
+//        .
+//  true,   
+bool CHeaderView::updateLevelBottom()
+{
+    QVector<int> bottoms;
+    int bottom = 0;
+    for (int row=0; row<sharedLayout->levels.size(); ++row)
+    {
+        bottom += sharedLayout->levels.at(row).size;
+        bottoms.push_back(bottom);
+    }
+
+    if (bottoms == levelBottom)
+        return false;
+    levelBottom = bottoms;
+    return true;
+}
+//        
+void CHeaderView::updateLevels()
+{
+    if (updateLevelBottom())
+    {
+        updateGeometry();
+        emit geometriesChanged();
+    }
+    viewport()->update();
+    emit headerLayoutUpdated();
+}
+//    ,   initializeSections()   .
+//     ,     
+void CHeaderView::invalidateLayout()
+{
+    progressiveTimer.stop();
+    sharedLayout = QExplicitlySharedDataPointer<SharedLayout>(new SharedLayout);
+    sharedLayout->revision = layoutRevision;
+    sectionHint.clear();
+}
+//    ,  .  
+//      ,  ,  
+//      ,      
+// (    ).     false
+bool CHeaderView::beginLayoutChange()
+{
+    if (++layoutRevision <= sharedLayout->revision)
+        return false;
+    sharedLayout->revision = layoutRevision;
+    return true;
+}
+//     ,    :
+//    
+void CHeaderView::clearSectionHints(int first, int last)
+{
+    for (int col = qMax(first, 0); col <= last && col < sectionHint.size(); ++col)
+        sectionHint[col] = -1;
+}
+//    :     
+//  ,          .
+// ,       ,  
+void CHeaderView::headerCellsChanged(Qt::Orientation orientation, int first, int last)
+{
+    CHeaderModel *cmodel = headerModel.data();
+    if (!cmodel || orientation != this->orientation())
+        return;
+
+    updateSearchRange(cmodel, first, last);
+    removeCachedCells(first, last);
+    if (sharedLayout->levels.size() != levelCount)
+        return;
+
+    int sections = modelSectionCount();
+    first = qMax(first, 0);
+    last  = qMin(last, sections-1);
+    if (first > last || sharedLayout->levels.isEmpty() || sharedLayout->levels.at(0).cellSize.size() != sections)
+        return;
+
+    bool apply = beginLayoutChange();
+    if (!apply && sectionHint.isEmpty())
+    {
+        updateLevels();
+        return;
+    }
+
+    bool changed = !apply;
+    for (int row = 0; row < levelCount; ++row)
+    {
+        //    
+        int from = first,
+            to   = last;
+        for (int col = first; col <= last; ++col)
+        {
+            QModelIndex index = cmodel->headerIndex(this->orientation(),row,col);
+            if (!index.isValid())
+                continue;
+            if (apply)
+                sharedLayout->levels[index.row()].cellSize[index.column()] = QSize();
+
+            QVariant span = cmodel->headerData(index, this->orientation(), CHeaderModel::SectionSpanRole);
+            int cellspan  = span.canConvert<uint>()? qBound(1,span.value<int>(),sections-index.column()) : 1;
+            from = qMin(from, index.column());
+            to   = qMax(to, index.column()+cellspan-1);
+        }
+        clearSectionHints(from, to);
+        if (apply)
+            changed |= updateLevelCells(cmodel, row, from, to);
+    }
+
+    if (changed)
+        updateLevels();
+    else
+        emit headerLayoutUpdated();
+}
+//   :    ,
+//        
+void CHeaderView::headerSpansChanged(Qt::Orientation orientation, int first, int last)
+{
+    CHeaderModel *cmodel = headerModel.data();
+    if (!cmodel || orientation != this->orientation())
+        return;
+
+    updateSearchRange(cmodel, first, last);
+    removeCachedCells(first, last);
+    if (sharedLayout->levels.size() != levelCount)
+        return;
+
+    int sections = modelSectionCount();
+    first = qMax(first, 0);
+    last  = qMin(last, sections-1);
+    if (first > last || sharedLayout->levels.isEmpty() || sharedLayout->levels.at(0).cellSize.size() != sections)
+        return;
+
+    // ,       ,
+    //       
+    clearSectionHints(first, last);
+    bool apply   = beginLayoutChange(),
+         changed = !apply;
+    for (int row = 0; apply && row < levelCount; ++row)
+        changed |= updateLevelCells(cmodel, row, first, last);
+
+    resizeSections();
+    if (changed)
+        updateLevels();
+    else
+    {
+        viewport()->update();
+        emit headerLayoutUpdated();
+    }
+}
+//    -:     
+//  ,      ( 
+//    )
+void CHeaderView::headerLayoutChanged(const QList<QPersistentModelIndex> &parents,
+                                      QAbstractItemModel::LayoutChangeHint hint)
+{
+    Q_UNUSED(parents);
+    if ((orientation() == Qt::Horizontal && hint == QAbstractItemModel::VerticalSortHint) ||
+        (orientation() == Qt::Vertical && hint == QAbstractItemModel::HorizontalSortHint))
+        return;
+
+    int sections = modelSectionCount();
+    if (sections > 0)
+    {
+        headerCellsChanged(orientation(), 0, sections-1);
+        resizeSections();
+    }
+}
+//   :  ,    .
+//      ,   
+//        
+void CHeaderView::headerSectionsInserted(const QModelIndex &parent, int first, int last)
+{
+    CHeaderModel *cmodel = headerModel.data();
+    if (!cmodel || parent != rootIndex())
+        return;
+
+    cellCache.clear();
+    insertSearchSections(cmodel, first, last);
+    if (sharedLayout->levels.isEmpty() || sharedLayout->levels.size() != levelCount)
+        return;
+
+    //        
+    int sections = modelSectionCount(),
+        inserted = last-first+1;
+    bool apply   = beginLayoutChange();
+    if (sharedLayout->levels.at(0).cellSize.size()+(apply? inserted : 0) != sections)
+    {
+        invalidateLayout();
+        scheduleDelayedItemsLayout();
+        return;
+    }
+    if (!sectionHint.isEmpty())
+        sectionHint.insert(first, inserted, -1);
+    if (!apply)
+    {
+        updateLevels();
+        return;
+    }
+
+    for (int row = 0; row < levelCount; ++row)
+    {
+        sharedLayout->levels[row].cellSize.insert(first, inserted, QSize());
+        sharedLayout->levels[row].cellExtent.insert(first, inserted, 0);
+    }
+
+    if (updateSectionRange(cmodel, first, last))
+        updateLevels();
+}
+//   :       ,
+//    ,  
+void CHeaderView::headerSectionsRemoved(const QModelIndex &parent, int first, int last)
+{
+    CHeaderModel *cmodel = headerModel.data();
+    if (!cmodel || parent != rootIndex())
+        return;
+
+    cellCache.clear();
+    removeSearchSections(cmodel, first, last);
+    if (sharedLayout->levels.isEmpty() || sharedLayout->levels.size() != levelCount)
+        return;
+
+    //        
+    int sections = modelSectionCount(),
+        removed  = last-first+1;
+    bool apply   = beginLayoutChange();
+    if (sharedLayout->levels.at(0).cellSize.size()-(apply? removed : 0) != sections)
+    {
+        invalidateLayout();
+        scheduleDelayedItemsLayout();
+        return;
+    }
+    if (!sectionHint.isEmpty())
+        sectionHint.remove(first, removed);
+    if (!apply)
+    {
+        updateLevels();
+        return;
+    }
+
+    bool changed = false;
+    for (int row = 0; row < levelCount; ++row)
+    {
+        LevelLayout &level = sharedLayout->levels[row];
+        //   ,    ,   
+        bool rescan = false;
+        for (int col = first; col <= last && !rescan; ++col)
+            rescan = level.cellExtent.at(col) == level.size;
+
+        level.cellSize.remove(first, removed);
+        level.cellExtent.remove(first, removed);
+
+        if (rescan)
+        {
+            int oldSize = level.size;
+            level.size = level.restoredSize;
+            for (int col = 0; col < level.cellExtent.size(); ++col)
+                level.size = qMax(level.size, level.cellExtent.at(col));
+            changed |= level.size != oldSize;
+        }
+    }
+    changed |= updateSectionRange(cmodel, first-1, first);
+
+    if (changed)
+        updateLevels();
+}
+//   :     ,
+//          
+void CHeaderView::headerSectionsMoved(const QModelIndex &parent, int start, int end,
+                                      const QModelIndex &destination, int section)
+{
+    CHeaderModel *cmodel = headerModel.data();
+    if (!cmodel || parent != rootIndex() || destination != rootIndex())
+        return;
+
+    cellCache.clear();
+    invalidateSelection();
+    moveSearchSections(cmodel, start, end, section);
+    int sections = modelSectionCount();
+    if (sharedLayout->levels.isEmpty() || sharedLayout->levels.size() != levelCount ||
+        sharedLayout->levels.at(0).cellSize.size() != sections)
+        return;
+
+    int count    = end-start+1,
+        newStart = section > end? section-count : section;
+    if (newStart == start)
+        return;
+
+    if (!sectionHint.isEmpty())
+    {
+        if (section > end)
+            std::rotate(sectionHint.begin()+start, sectionHint.begin()+end+1, sectionHint.begin()+section);
+        else
+            std::rotate(sectionHint.begin()+section, sectionHint.begin()+start, sectionHint.begin()+end+1);
+    }
+    //      
+    if (!beginLayoutChange())
+    {
+        updateLevels();
+        return;
+    }
+
+    for (int row = 0; row < levelCount; ++row)
+    {
+        LevelLayout &level = sharedLayout->levels[row];
+        if (section > end)
+        {
+            std::rotate(level.cellSize.begin()+start, level.cellSize.begin()+end+1, level.cellSize.begin()+section);
+            std::rotate(level.cellExtent.begin()+start, level.cellExtent.begin()+end+1, level.cellExtent.begin()+section);
+        }
+        else
+        {
+            std::rotate(level.cellSize.begin()+section, level.cellSize.begin()+start, level.cellSize.begin()+end+1);
+            std::rotate(level.cellExtent.begin()+section, level.cellExtent.begin()+start, level.cellExtent.begin()+end+1);
+        }
+    }
+
+    // ,  ,      
+    int gap = section > end? start : end+1;
+    bool changed = updateSectionRange(cmodel, gap-1, gap);
+    changed |= updateSectionRange(cmodel, newStart-1, newStart+count);
+
+    if (changed)
+        updateLevels();
+    else
+    {
+        viewport()->update();
+        emit headerLayoutUpdated();
+    }
+}
+//      ,    
+//     .  true,    
+bool CHeaderView::updateSectionRange(CHeaderModel *cmodel, int first, int last)
+{
+    first = qMax(first, 0);
+    last  = qMin(last, modelSectionCount()-1);
+    if (first > last)
+        return false;
+
+    bool changed = false;
+    for (int row = 0; row < levelCount; ++row)
+    {
+        int from = first,
+            to   = last;
+        QModelIndex index = cmodel->headerIndex(orientation(),row,first);
+        if (index.isValid())
+            from = qMin(from, index.column());
+        index = cmodel->headerIndex(orientation(),row,last);
+        if (index.isValid())
+        {
+            int lastSection, lastLevel;
+            cellSpan(cmodel, index, lastSection, lastLevel);
+            to = qMax(to, lastSection);
+        }
+        changed |= updateLevelCells(cmodel, row, from, to);
+    }
+    return changed;
+}
+//      ,    
+void CHeaderView::removeCachedCells(int first, int last)
+{
+    QList<CellKey> keys = cellCache.keys();
+    for (int i = 0; i < keys.size(); ++i)
+        if (keys.at(i).column <= last && keys.at(i).lastSection >= first)
+            cellCache.remove(keys.at(i));
+}
+//         ,
+//  ,    -   .
+//         
+bool CHeaderView::event(QEvent *e)
+{
+    if (e->type() == QEvent::FontChange || e->type() == QEvent::StyleChange)
+    {
+        invalidateLayout();
+        scheduleDelayedItemsLayout();
+    }
+    if (e->type() == QEvent::FontChange || e->type() == QEvent::StyleChange ||
+        e->type() == QEvent::PaletteChange)
+        cellCache.clear();
+    if (e->type() == QEvent::Show)
+        watchScreen();
+    return QHeaderView::event(e);
+}
+//        
+// (       )
+void CHeaderView::watchScreen()
+{
+    QWindow *handle = window()->windowHandle();
+    if (handle == screenWindow)
+        return;
+    if (screenWindow)
+        disconnect(screenWindow, SIGNAL(screenChanged(QScreen*)), this, SLOT(headerScreenChanged()));
+    screenWindow = handle;
+    if (screenWindow)
+        connect(screenWindow, SIGNAL(screenChanged(QScreen*)), SLOT(headerScreenChanged()));
+}
+//   :       
+//  ,     
+void CHeaderView::headerScreenChanged()
+{
+    invalidateLayout();
+    cellCache.clear();
+    scheduleDelayedItemsLayout();
+}
+//    :    ,
+//    progressiveSliceTime(),     
+void CHeaderView::timerEvent(QTimerEvent *e)
+{
+    if (e->timerId() != progressiveTimer.timerId())
+    {
+        QHeaderView::timerEvent(e);
+        return;
+    }
+
+    CHeaderModel *cmodel = headerModel.data();
+    int sections = modelSectionCount();
+    if (!cmodel || !progressiveMode || !layoutMatchesModel(sections))
+    {
+        progressiveTimer.stop();
+        return;
+    }
+
+    //   ,     .
+    //           
+    enum { BlockSections = 64 };
+    QElapsedTimer timer;
+    timer.start();
+    bool measured      = false,
+         changed       = false,
+         resizePending = !pendingSections.isEmpty();
+    do
+    {
+        int last = qMin(sections-1, progressiveNext+BlockSections-1);
+        measured |= measureSectionRange(cmodel, progressiveNext, last, changed);
+        progressiveNext = last+1;
+    }
+    while (progressiveNext < sections && !timer.hasExpired(progressiveSlice));
+    ++progressiveSlices;
+
+    if (measured)
+    {
+        applyMeasuredSections(changed, resizePending);
+        viewport()->update();
+    }
+    if (progressiveNext < sections)
+        return;
+
+    progressiveTimer.stop();
+    qCDebug(lcHeaderView, "progressive layout: %d sections, %d slices", sections, progressiveSlices);
+    emit layoutCompleted();
+}
+//      
+//   -     
+QSize CHeaderView::cellSizeFromContents(const QModelIndex &index) const
+{
+
+
+
+    CHeaderModel *cmodel = headerModel.data();
+
+    if (!index.isValid() || !cmodel)
+        return QSize();
+
+    if (statisticsMode)
+        ++stats.cellSizeCalls;
+    ensurePolished();
+
+    QStyleOptionHeader opt;
+    initStyleOption(&opt);
+
+    // use SizeHintRole or the size of the same contents measured before
+    MeasureKey key;
+    QSize size;
+    if (!cellMeasureKey(cmodel, index, style()->pixelMetric(QStyle::PM_SmallIconSize, &opt, this),
+                        key, opt.icon, size) || !size.isEmpty())
+        return size;
+
+    // otherwise use the contents
+    opt.section = index.column();
+    opt.fontMetrics = QFontMetrics(key.font);
+    opt.text = key.text;
+
+    size = style()->sizeFromContents(QStyle::CT_HeaderSection, &opt, QSize(), this);
+    int margin = style()->pixelMetric(QStyle::PM_HeaderMargin, &opt, this);
+    size = adjustedCellSize(size, key.rotated, margin);
+    sharedLayout->measureCache.insert(key, size);
+    return size;
+}
+//    ,   ,    .
+//  false,     (SizeHintRole);  
+//            
+bool CHeaderView::cellMeasureKey(CHeaderModel *cmodel, const QModelIndex &index, int iconExtent,
+                                 MeasureKey &key, QIcon &icon, QSize &size) const
+{
+    enum { SizeHint, Font, Display, Decoration, Rotation, RoleCount };
+    CHeaderModel::HeaderRoleData data[RoleCount];
+    data[SizeHint].role   = Qt::SizeHintRole;
+    data[Font].role       = Qt::FontRole;
+    data[Display].role    = Qt::DisplayRole;
+    data[Decoration].role = Qt::DecorationRole;
+    data[Rotation].role   = CHeaderModel::RotationRole;
+    cmodel->headerMultiData(index, orientation(), data, RoleCount);
+
+    if (data[SizeHint].data.isValid())
+    {
+        size = qvariant_cast<QSize>(data[SizeHint].data);
+        return false;
+    }
+
+    if (data[Font].data.isValid() && data[Font].data.canConvert<QFont>())
+        key.font = qvariant_cast<QFont>(data[Font].data);
+    else
+        key.font = font();
+    key.font.setBold(true);
+    key.text = data[Display].data.toString();
+    icon = qvariant_cast<QIcon>(data[Decoration].data);
+    if (icon.isNull())
+        icon = qvariant_cast<QPixmap>(data[Decoration].data);
+    key.iconSize      = icon.isNull()? QSize() : icon.actualSize(QSize(iconExtent, iconExtent));
+    key.rotated       = data[Rotation].data.toBool();
+    key.sortIndicator = isSortIndicatorShown();
+    key.style         = style();
+
+    QHash<MeasureKey,QSize>::const_iterator it = sharedLayout->measureCache.constFind(key);
+    if (it != sharedLayout->measureCache.constEnd())
+        size = it.value();
+    if (statisticsMode)
+        ++(size.isEmpty()? stats.measureCacheMisses : stats.measureCacheHits);
+    return true;
+}
+//        
+QSize CHeaderView::adjustedCellSize(QSize size, bool rotated, int margin) const
+{
+    int SortIndicatorSize = 0;
+    if (isSortIndicatorShown()) {
+        if (orientation() == Qt::Horizontal)
+            SortIndicatorSize = size.height() + margin;
+        else
+            SortIndicatorSize = size.width() + margin;
+    }
+    //    
+    if (rotated)
+        size.transpose();
+
+    if (orientation() == Qt::Horizontal)
+        size.rwidth() += SortIndicatorSize;
+    else
+        size.rheight() += SortIndicatorSize;
+
+     return size;
+}
+
+//       
+//   -   ()  
+QSize CHeaderView::sectionSizeFromContents(int section) const
+{
+    CHeaderModel *cmodel = headerModel.data();
+    if (!cmodel)
+        return QHeaderView::sectionSizeFromContents(section);
+
+    QSize sectionSizeHint = QSize(0,0);
+
+    if (isSectionHidden(section))
+      return sectionSizeHint;
+
+    //     ,     
+    if (section < sectionHint.size() && sectionHint.at(section) >= 0)
+    {
+        int thickness = levelBottom.isEmpty()? 0 : levelBottom.last();
+        return orientation() == Qt::Horizontal? QSize(sectionHint.at(section), thickness) :
+                                                QSize(thickness, sectionHint.at(section));
+    }
+
+    bool estimated = false;
+    for (int row = 0; row < levelCount; ++row)
+    {
+
+        QModelIndex index = cmodel->headerIndex(orientation(),row,section);
+        QSize cellSize = deferredSizing()? knownCellSize(index) : cachedCellSize(index);
+        if (deferredSizing() && index.isValid() && !cellSize.isValid())
+        {
+            //         
+            estimated = true;
+            continue;
+        }
+        //       (   )
+        int lastSection, lastLevel;
+        cellSpan(cmodel, index, lastSection, lastLevel);
+        int sections = qMax(1, visibleSectionCount(index.column(), lastSection));
+        if (orientation()==Qt::Horizontal)
+        {
+            cellSize.rwidth() /= sections;
+            cellSize.rheight()/= lastLevel-index.row()+1;
+        }
+        else
+        {
+            cellSize.rheight()/= sections;
+            cellSize.rwidth() /= lastLevel-index.row()+1;
+        }
+
+        if (orientation()==Qt::Horizontal)
+        {
+           //         
+            sectionSizeHint.rheight() += cellSize.height();
+            sectionSizeHint.setWidth(qMax(sectionSizeHint.width(), cellSize.width()));
+         }
+         else
+         {
+            //    
+            sectionSizeHint.rwidth() += cellSize.width();
+            sectionSizeHint.setHeight(qMax(sectionSizeHint.height(), cellSize.height()));
+          }
+    }
+
+    if (estimated && orientation()==Qt::Horizontal && sectionSizeHint.width() == 0)
+        sectionSizeHint.setWidth(defaultSectionSize());
+    if (estimated && orientation()==Qt::Vertical && sectionSizeHint.height() == 0)
+        sectionSizeHint.setHeight(defaultSectionSize());
+    return sectionSizeHint;
+}
+//        
+QModelIndex CHeaderView::IndexAt(const QPoint &pos) const
+{
+   return IndexAt(pos.x(), pos.y());
+}
+//        
+QModelIndex CHeaderView::IndexAt(int ax, int ay) const
+{
+    int pos = orientation()==Qt::Horizontal? ay : ax,
+        col = orientation()==Qt::Horizontal? logicalIndexAt(ax): logicalIndexAt(ay);
+
+    if(col >=0)
+    {
+        //  ,      ( )
+        int row = std::upper_bound(levelBottom.constBegin(), levelBottom.constEnd(), pos)-levelBottom.constBegin();
+        if (row < levelCount && row < levelBottom.size())
+        {
+            CHeaderModel *cmodel = headerModel.data();
+
+            return !cmodel ? QModelIndex() : cmodel->headerIndex(orientation(),row, col);
+        }
+    }
+  return QModelIndex();
+}
+//       
+// (      )
+void CHeaderView::paintSection(QPainter *painter, const QRect &rect, int col) const
+{
+    CHeaderModel *cmodel = headerModel.data();
+
+    if (!cmodel)
+        return QHeaderView::paintSection(painter,rect,col);
+
+    for (int row = 0; row < levelCount; ++row)
+    {
+        QModelIndex index = cmodel->headerIndex(orientation(),row,col);
+
+        if (!index.isValid()) continue;
+        painter->save();
+        paintCell(painter, index, col);
+        painter->restore();
+    }
+}
+//  .    QHeaderView::paintEvent()    ,
+//    :       
+//     ,    
+void CHeaderView::paintEvent(QPaintEvent *e)
+{
+    CHeaderModel *cmodel = headerModel.data();
+
+    if (!cmodel || count() == 0)
+        return QHeaderView::paintEvent(e);
+
+    QElapsedTimer timer;
+    if (statisticsMode || lcHeaderView().isDebugEnabled())
+        timer.start();
+
+    QPainter painter(viewport());
+    QRect area = e->rect();
+
+    int start = orientation() == Qt::Horizontal? visualIndexAt(area.left()) : visualIndexAt(area.top()),
+        end   = orientation() == Qt::Horizontal? visualIndexAt(area.right()) : visualIndexAt(area.bottom());
+    if (start == -1)
+        start = 0;
+    if (end == -1)
+        end = count()-1;
+    if (start > end)
+        qSwap(start, end);
+    //   ,     
+    start = logicalIndex(start);
+    end   = logicalIndex(end);
+
+    if (deferredSizing())
+        measureSections(start, end);
+
+    //     ,     
+    // , :      
+    if (pinningMode && offset() != paintedOffset)
+    {
+        QRegion stale = pinnedCellsRegion(cmodel, paintedOffset-offset()).subtracted(e->region());
+        if (!stale.isEmpty())
+            viewport()->update(stale);
+    }
+    paintedOffset = offset();
+
+    int cells = paintCells(&painter, cmodel, start, end);
+
+    //     
+    int sectionsEnd = length()-offset();
+    QStyleOption opt;
+    opt.initFrom(this);
+    if (orientation() == Qt::Horizontal && sectionsEnd <= area.right())
+    {
+        opt.state |= QStyle::State_Horizontal;
+        opt.rect = QRect(sectionsEnd, 0, area.right()-sectionsEnd+1, viewport()->height());
+        style()->drawControl(QStyle::CE_HeaderEmptyArea, &opt, &painter, this);
+    }
+    else
+    if (orientation() == Qt::Vertical && sectionsEnd <= area.bottom())
+    {
+        opt.rect = QRect(0, sectionsEnd, viewport()->width(), area.bottom()-sectionsEnd+1);
+        style()->drawControl(QStyle::CE_HeaderEmptyArea, &opt, &painter, this);
+    }
+
+    if (timer.isValid())
+    {
+        qint64 elapsed = timer.nsecsElapsed();
+        if (statisticsMode)
+        {
+            ++stats.paintEvents;
+            stats.paintTime    += elapsed;
+            stats.cellsPainted += cells;
+        }
+        qCDebug(lcHeaderView, "paintEvent: %d cells, %.3f ms", cells, elapsed/1e6);
+    }
+}
+//   ,   ,   viewport:
+//       ,    .
+//    
+int CHeaderView::paintCells(QPainter *painter, CHeaderModel *cmodel, int start, int end) const
+{
+    int cells = 0;
+    for (int row = 0; row < levelCount; ++row)
+    {
+        for (int col = start; col <= end; )
+        {
+            QModelIndex index = isSectionHidden(col)? QModelIndex() : cmodel->headerIndex(orientation(),row,col);
+            if (!index.isValid())
+            {
+                ++col;
+                continue;
+            }
+
+            int lastSection, lastLevel;
+            cellSpan(cmodel, index, lastSection, lastLevel);
+
+            // ,    ,     
+            if (index.row() == row || cmodel->headerIndex(orientation(),row-1,col) != index)
+            {
+                painter->save();
+                paintCell(painter, index, index.column());
+                painter->restore();
+                ++cells;
+            }
+            col = qMax(col+1, lastSection+1);
+        }
+    }
+    return cells;
+}
+//     :  ,  
+//     ,    , ,  
+//   .         
+//  .   ,     
+//     (. CHeaderModel::headerContentHash)
+QByteArray CHeaderView::saveLayout() const
+{
+    CHeaderModel *cmodel = headerModel.data();
+    int sections = modelSectionCount();
+    if (!cmodel || sharedLayout->levels.size() != levelCount ||
+        (levelCount > 0 && sharedLayout->levels.at(0).cellSize.size() != sections) ||
+        !cmodel->headerContentHash(orientation()))
+        return QByteArray();
+
+    QVector<qint32> hints(sections, -1);
+    for (int col = 0; col < sections; ++col)
+    {
+        if (isSectionHidden(col))
+            continue;
+        if (col < sectionHint.size() && sectionHint.at(col) >= 0)
+        {
+            hints[col] = sectionHint.at(col);
+            continue;
+        }
+        bool measured = true;
+        for (int row = 0; row < levelCount && measured; ++row)
+        {
+            QModelIndex index = cmodel->headerIndex(orientation(),row,col);
+            measured = !index.isValid() || sharedLayout->levels.at(index.row()).cellSize.at(index.column()).isValid();
+        }
+        if (measured)
+        {
+            QSize size = sectionSizeFromContents(col);
+            hints[col] = orientation() == Qt::Horizontal? size.width() : size.height();
+        }
+    }
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_6);
+    stream << quint32(LayoutMagic) << quint16(LayoutVersion) << quint8(orientation())
+           << quint32(layoutFingerprint(cmodel)) << qint32(sections) << qint32(levelCount)
+           << cmodel->headerSaveSpans(orientation());
+    for (int row = 0; row < levelCount; ++row)
+        stream << qint32(sharedLayout->levels.at(row).size);
+    stream << hints;
+    return data;
+}
+//       . ,  
+//  ,   , ,     .
+//            
+bool CHeaderView::restoreLayout(const QByteArray &data)
+{
+    CHeaderModel *cmodel = headerModel.data();
+    if (!cmodel)
+    {
+        pendingLayout = data;
+        return true;
+    }
+    if (!applyLayout(cmodel, data))
+    {
+        if (sharedLayout->levels.size() != levelCount)
+            initializeSections();
+        return false;
+    }
+
+    cellCache.clear();
+    initializeSections();
+    resizeSections();
+    updateGeometry();
+    emit geometriesChanged();
+    viewport()->update();
+    emit headerLayoutUpdated();
+    return true;
+}
+//             
+bool CHeaderView::applyLayout(CHeaderModel *cmodel, const QByteArray &data)
+{
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_5_6);
+
+    quint32 magic, fingerprint;
+    quint16 version;
+    quint8 orient;
+    qint32 sections, levels;
+    QByteArray spans;
+    stream >> magic >> version >> orient >> fingerprint >> sections >> levels >> spans;
+    if (stream.status() != QDataStream::Ok || magic != LayoutMagic || version != LayoutVersion ||
+        orient != quint8(orientation()) || sections != modelSectionCount() ||
+        levels != cmodel->headerCount(orientation()) || !cmodel->headerContentHash(orientation()) ||
+        fingerprint != layoutFingerprint(cmodel))
+        return false;
+
+    //   :       ,
+    //          
+    QVector<LevelLayout> layout(levels);
+    for (int row = 0; row < levels; ++row)
+    {
+        LevelLayout &level = layout[row];
+        qint32 size;
+        stream >> size;
+        if (stream.status() != QDataStream::Ok || size < 0)
+            return false;
+        level.cellSize.fill(QSize(), sections);
+        level.cellExtent.fill(0, sections);
+        level.size         = size;
+        level.restoredSize = size;
+    }
+    QVector<qint32> hints;
+    stream >> hints;
+    if (stream.status() != QDataStream::Ok || !stream.atEnd() || hints.size() != sections)
+        return false;
+    for (int col = 0; col < sections; ++col)
+        if (hints.at(col) < -1)
+            return false;
+
+    //     :  
+    //       
+    if (!cmodel->headerCheckSpans(orientation(), spans))
+        return false;
+
+    //     ,   
+    //       .  
+    //      (initializeSections)
+    invalidateLayout();
+    if (!cmodel->headerRestoreSpans(orientation(), spans))
+        return false;
+
+    levelCount  = levels;
+    sharedLayout->levels = layout;
+    sectionHint = hints;
+    updateLevelBottom();
+    return true;
+}
+//  ,    :  ,
+// , ,  ,   ,    
+uint CHeaderView::layoutFingerprint(CHeaderModel *cmodel) const
+{
+    ensurePolished();
+    uint hash = cmodel->headerContentHash(orientation());
+    hash = qHash(font().toString(), hash);
+    hash = qHash(QByteArray(style()->metaObject()->className()), hash);
+    hash = qHash(styleSheet(), hash);
+    hash = qHash(devicePixelRatioF(), hash);
+    hash = qHash(logicalDpiX(), qHash(logicalDpiY(), hash));
+    hash = qHash(int(orientation()) | int(isSortIndicatorShown()) << 2, hash);
+    return hash;
+}
+//    (    )  
+QSize CHeaderView::exportSize() const
+{
+    int thickness = levelBottom.isEmpty()? 0 : levelBottom.last();
+    return orientation() == Qt::Horizontal? QSize(length(), thickness) : QSize(thickness, length());
+}
+//      length,    position
+// (     ),    painter.
+//     ,    ;  ,
+//   ,      .
+//        
+void CHeaderView::exportTile(QPainter *painter, int position, int length)
+{
+    CHeaderModel *cmodel = headerModel.data();
+    if (!cmodel || count() == 0 || length <= 0)
+        return;
+
+    int first = logicalIndexAt(position-offset()),
+        last  = logicalIndexAt(position+length-1-offset());
+    if (first < 0)
+        return;
+    if (last < 0)
+        last = count()-1;
+
+    if (deferredSizing())
+        measureSections(first, last);
+
+    QSize size = exportSize();
+    painter->save();
+    if (orientation() == Qt::Horizontal)
+    {
+        painter->setClipRect(QRect(0, 0, length, size.height()), Qt::IntersectClip);
+        painter->translate(offset()-position, 0);
+    }
+    else
+    {
+        painter->setClipRect(QRect(0, 0, size.width(), length), Qt::IntersectClip);
+        painter->translate(0, offset()-position);
+    }
+    painter->setFont(font());
+
+    exportMode = true;
+    paintCells(painter, cmodel, first, last);
+    exportMode = false;
+
+    painter->restore();
+}
+//      painter (, PDF  ) 
+//  tileLength:        
+void CHeaderView::exportHeader(QPainter *painter, int tileLength)
+{
+    tileLength = qMax(1, tileLength);
+    for (int position = 0; position < length(); position += tileLength)
+    {
+        painter->save();
+        if (orientation() == Qt::Horizontal)
+            painter->translate(position, 0);
+        else
+            painter->translate(0, position);
+        exportTile(painter, position, qMin(tileLength, length()-position));
+        painter->restore();
+    }
+}
+//       ,  
+void CHeaderView::cellSpan(CHeaderModel *cmodel, const QModelIndex &index, int &lastSection, int &lastLevel) const
+{
+    lastSection = index.column();
+    lastLevel   = index.row();
+
+    CHeaderModel::HeaderRoleData span[2];
+    span[0].role = CHeaderModel::SectionSpanRole;
+    span[1].role = CHeaderModel::LevelSpanRole;
+    cmodel->headerMultiData(index, orientation(), span, 2);
+
+    if (span[0].data.canConvert<uint>())
+        lastSection = index.column()+qBound(1,span[0].data.value<int>(),count()-index.column())-1;
+    if (span[1].data.canConvert<uint>())
+         lastLevel  = index.row()+qBound(1,span[1].data.value<int>(),levelCount-index.row())-1;
+}
+//   :     
+//    ,   
+void CHeaderView::headerSelectionChanged(const QItemSelection &selected, const QItemSelection &deselected)
+{
+    CHeaderModel *cmodel = headerModel.data();
+    if (!cmodel)
+    {
+        viewport()->update();
+        return;
+    }
+
+    int sections = modelSectionCount(),
+        first    = sections,
+        last     = -1;
+    bool valid   = !selectionDirty && sectionSelected.size() == sections;
+
+    //         
+    for (int i = 0; i < deselected.size(); ++i)
+    {
+        const QItemSelectionRange &range = deselected.at(i);
+        if (range.parent() != rootIndex())
+            continue;
+        int from = qMax(0, orientation() == Qt::Horizontal? range.left() : range.top()),
+            to   = qMin(sections-1, orientation() == Qt::Horizontal? range.right() : range.bottom());
+        for (int section = from; valid && section <= to; ++section)
+            sectionSelected.clearBit(section);
+        first = qMin(first, from);
+        last  = qMax(last, to);
+    }
+
+    //    ()   ,  
+    //     
+    int items = orientation() == Qt::Horizontal? model()->rowCount(rootIndex()) : model()->columnCount(rootIndex());
+    for (int i = 0; i < selected.size(); ++i)
+    {
+        const QItemSelectionRange &range = selected.at(i);
+        if (range.parent() != rootIndex())
+            continue;
+        int from = qMax(0, orientation() == Qt::Horizontal? range.left() : range.top()),
+            to   = qMin(sections-1, orientation() == Qt::Horizontal? range.right() : range.bottom());
+        bool whole = orientation() == Qt::Horizontal? range.top() == 0 && range.bottom() == items-1 :
+                                                      range.left() == 0 && range.right() == items-1;
+        for (int section = from; valid && section <= to; ++section)
+        {
+            if (whole)
+                sectionSelected.setBit(section);
+            else
+                sectionSelected.setBit(section, orientation() == Qt::Horizontal?
+                                                selectionModel()->isColumnSelected(section, rootIndex()) :
+                                                selectionModel()->isRowSelected(section, rootIndex()));
+        }
+        first = qMin(first, from);
+        last  = qMax(last, to);
+    }
+
+    if (first > last || levelBottom.size() != levelCount)
+        return;
 
-            opt.text = opt.fontMetrics.elidedText(opt.text, Qt::ElideRight , opt.rect.width() - 4);
+    //   ,   
+    int extent = orientation() == Qt::Horizontal? viewport()->width() : viewport()->height(),
+        start  = logicalIndexAt(0),
+        end    = logicalIndexAt(extent-1);
+    first = qMax(first, start < 0? 0 : start);
+    last  = qMin(last, end < 0? sections-1 : end);
+
+    QRegion region;
+    for (int row = 0; row < levelCount; ++row)
+    {
+        for (int col = first; col <= last; )
+        {
+            QModelIndex index = cmodel->headerIndex(orientation(),row,col);
+            if (!index.isValid())
+            {
+                ++col;
+                continue;
+            }
+            int lastSection, lastLevel;
+            cellSpan(cmodel, index, lastSection, lastLevel);
+            region += cellRect(index, lastSection, lastLevel);
+            col = qMax(col+1, lastSection+1);
+        }
+    }
+    if (!region.isEmpty())
+        viewport()->update(region);
+}
+//     .     ,
+//       ( ,    )
+bool CHeaderView::isSectionSelected(int section) const
+{
+    if (!selectionModel())
+        return false;
 
+    int sections = modelSectionCount();
+    if (selectionDirty || sectionSelected.size() != sections)
+    {
+        sectionSelected.fill(false, sections);
+        for (int i = 0; i < sections; ++i)
+            if (orientation() == Qt::Horizontal? selectionModel()->isColumnSelected(i, rootIndex()) :
+                                                 selectionModel()->isRowSelected(i, rootIndex()))
+                sectionSelected.setBit(i);
+        selectionDirty = false;
+    }
+    return section >= 0 && section < sections && sectionSelected.testBit(section);
+}
+//     ,      .
+//       () ,   
+//   selectionChanged
+void CHeaderView::invalidateSelection()
+{
+    selectionDirty = true;
+    viewport()->update();
+}
+//       viewport
+QRect CHeaderView::cellRect(const QModelIndex &index, int lastSection, int lastLevel) const
+{
+    int left   = sectionViewportPosition(index.column()),
+        top    = index.row()==0? 0: levelBottom.at(index.row()-1),
+        width  = sectionViewportPosition(lastSection)+sectionSize(lastSection)-left,
+        height = levelBottom.at(lastLevel)-top;
 
-            // draw the section
-            style()->drawControl(QStyle::CE_HeaderLabel, &opt, painter, this);
+    return orientation() == Qt::Horizontal? QRect(left, top, width, height):
+                                            QRect(top, left, height, width);
+}
+//     :    - 
+//  ,    ,  -  
+QRect CHeaderView::pinnedLabelRect(const QRect &rect) const
+{
+    if (!pinningMode || exportMode)
+        return rect;
+    QRect visible = rect & viewport()->rect();
+    return visible.isEmpty()? rect : visible;
+}
+//     ,      
+//    delta  (    )
+QRegion CHeaderView::pinnedCellsRegion(CHeaderModel *cmodel, int delta) const
+{
+    QRegion region;
+    QRect view    = viewport()->rect(),
+          oldView = orientation() == Qt::Horizontal? view.translated(delta, 0) : view.translated(0, delta);
+    int extent    = orientation() == Qt::Horizontal? view.width() : view.height();
+    //      
+    int edges[4]  = { 0, extent-1, delta, extent-1+delta };
 
-            painter->setBrushOrigin(oldBO);
-            painter->restore();
+    for (int i = 0; i < 4; ++i)
+    {
+        int section = edges[i] >= 0 && edges[i] < extent? logicalIndexAt(edges[i]) : -1;
+        if (section < 0)
+            continue;
+        for (int row = 0; row < levelCount; ++row)
+        {
+            // ,    ,    
+            QModelIndex index = cmodel->headerIndex(orientation(), row, section);
+            if (!index.isValid() || index.row() != row)
+                continue;
 
+            int lastSection, lastLevel;
+            cellSpan(cmodel, index, lastSection, lastLevel);
+            QRect rect = cellRect(index, lastSection, lastLevel);
+            if (!view.contains(rect) || !oldView.contains(rect))
+                region += rect & view;
         }
+    }
+    return region;
+}
+//    ( )  .
+//       ,  
+//    , ,    
+void CHeaderView::paintCell(QPainter *painter, const QModelIndex &index, int section) const
+{
+    CHeaderModel *cmodel = headerModel.data();
+
+    int lastSection, lastLevel;
+    cellSpan(cmodel, index, lastSection, lastLevel);
+    QRect rect  = cellRect(index, lastSection, lastLevel),
+          label = pinnedLabelRect(rect);
+
+    bool selected = !exportMode && isSectionSelected(index.column()) && isSectionSelected(lastSection);
+
+    qreal dpr = viewport()->devicePixelRatioF();
+    int cost  = qRound(rect.width()*dpr)*qRound(rect.height()*dpr)*4/1024+1;
+    //     ,    (PDF, )
+    //      ;   
+    //   ,     
+    if (cellCache.maxCost() == 0 || cost > cellCache.maxCost() || rect.isEmpty() || exportMode || label != rect)
+    {
+        drawCell(painter, index, section, rect, label, selected);
+        return;
+    }
+
+    CellKey key;
+    key.row         = index.row();
+    key.column      = index.column();
+    key.lastSection = lastSection;
+    key.width       = rect.width();
+    key.height      = rect.height();
+    key.state       = (isEnabled()? 1 : 0) | (window()->isActiveWindow()? 2 : 0) | (selected? 4 : 0) |
+                      (isHoverCell(index)? 8 : 0) | (isHighlightCell(index)? 16 : 0);
+    key.dpr         = qRound(dpr*100);
+
+    QPixmap *pixmap = cellCache.object(key);
+    if (statisticsMode)
+        ++(pixmap? stats.pixmapCacheHits : stats.pixmapCacheMisses);
+    if (!pixmap)
+    {
+        pixmap = new QPixmap(qRound(rect.width()*dpr), qRound(rect.height()*dpr));
+        pixmap->setDevicePixelRatio(dpr);
+        pixmap->fill(Qt::transparent);
+
+        QPainter pixmapPainter(pixmap);
+        pixmapPainter.setFont(painter->font());
+        drawCell(&pixmapPainter, index, section, QRect(QPoint(0,0), rect.size()),
+                 QRect(QPoint(0,0), rect.size()), selected);
+        pixmapPainter.end();
+
+        cellCache.insert(key, pixmap, cost);
+    }
+    painter->drawPixmap(rect.topLeft(), *pixmap);
+}
+//       
+void CHeaderView::drawCell(QPainter *painter, const QModelIndex &index, int section, const QRect &rect,
+                           const QRect &labelRect, bool selected) const
+{
+    CHeaderModel *cmodel = headerModel.data();
+
+    enum { Font, TextAlignment, Display, Decoration, Foreground, Background, Rotation, RoleCount };
+    CHeaderModel::HeaderRoleData data[RoleCount];
+    data[Font].role          = Qt::FontRole;
+    data[TextAlignment].role = Qt::TextAlignmentRole;
+    data[Display].role       = Qt::DisplayRole;
+    data[Decoration].role    = Qt::DecorationRole;
+    data[Foreground].role    = Qt::ForegroundRole;
+    data[Background].role    = Qt::BackgroundRole;
+    data[Rotation].role      = CHeaderModel::RotationRole;
+    cmodel->headerMultiData(index, orientation(), data, RoleCount);
+
+    // get the state of the section
+    QStyleOptionHeader opt;
+    initStyleOption(&opt);
+
+    const QVariant &font = data[Font].data;
+    if (font.isValid() && font.canConvert<QFont>()) {
+        QFont sectionFont = qvariant_cast<QFont>(font);
+        painter->setFont(sectionFont);
+    }
+
+    // setup the style options structure
+    const QVariant &textAlignment = data[TextAlignment].data;
+
+    opt.rect = rect;
+    opt.section = section;
+
+    opt.textAlignment = Qt::Alignment(textAlignment.isValid()
+                                      ? Qt::Alignment(textAlignment.toInt())
+                                      : Qt::AlignCenter);
+
+    opt.iconAlignment = Qt::AlignVCenter;
+    opt.text = data[Display].data.toString();
+
+    const QVariant &variant = data[Decoration].data;
+    opt.icon = qvariant_cast<QIcon>(variant);
+    if (opt.icon.isNull())
+        opt.icon = qvariant_cast<QPixmap>(variant);
+    const QVariant &foregroundBrush = data[Foreground].data;
+    if (foregroundBrush.canConvert<QBrush>())
+        opt.palette.setBrush(QPalette::ButtonText, qvariant_cast<QBrush>(foregroundBrush));
+
+    QPointF oldBO = painter->brushOrigin();
+    const QVariant &backgroundBrush = data[Background].data;
+    if (backgroundBrush.canConvert<QBrush>()) {
+        opt.palette.setBrush(QPalette::Button, qvariant_cast<QBrush>(backgroundBrush));
+        opt.palette.setBrush(QPalette::Window, qvariant_cast<QBrush>(backgroundBrush));
+        painter->setBrushOrigin(opt.rect.topLeft());
+    }
+    // ,  ,   
+    if (isHighlightCell(index)) {
+        opt.palette.setBrush(QPalette::Button, palette().brush(QPalette::Highlight));
+        opt.palette.setBrush(QPalette::Window, palette().brush(QPalette::Highlight));
+        opt.palette.setBrush(QPalette::ButtonText, palette().brush(QPalette::HighlightedText));
+        painter->setBrushOrigin(opt.rect.topLeft());
+    }
+
+    // the section position
+    opt.position = QStyleOptionHeader::Middle;
+    opt.orientation = orientation();
+
+
+    if (isEnabled())
+        opt.state |= QStyle::State_Enabled;
+    if (window()->isActiveWindow())
+        opt.state |= QStyle::State_Active;
+
+    opt.selectedPosition = QStyleOptionHeader::NotAdjacent;
+
+    // the selected position
+    if (selected)
+        opt.state |= QStyle::State_Sunken | QStyle::State_On;
+    if (isHoverCell(index))
+        opt.state |= QStyle::State_MouseOver;
+
+    style()->drawControl(QStyle::CE_HeaderSection, &opt, painter, this);
+
+    //       (  )
+    opt.rect = labelRect;
+    if (data[Rotation].data.toBool())
+    {
+        painter->translate(opt.rect.left(), opt.rect.top() + opt.rect.height());
+        painter->rotate(-90);
+        opt.rect.setRect(0, 0, opt.rect.height(), opt.rect.width());
+    }
+
+    opt.text = opt.fontMetrics.elidedText(opt.text, Qt::ElideRight , opt.rect.width() - 4);
+
+
+    // draw the section
+    style()->drawControl(QStyle::CE_HeaderLabel, &opt, painter, this);
+
+    painter->setBrushOrigin(oldBO);
 }
 //     (    /   )
 void CHeaderView::mousePressEvent(QMouseEvent *e)
 {
     QHeaderView::mousePressEvent(e);
 
-    CHeaderModel *cmodel = dynamic_cast<CHeaderModel *>(model());
+    CHeaderModel *cmodel = headerModel.data();
     if (cmodel != NULL)
     {
         QModelIndex index = IndexAt(e->pos());
@@ -458,21 +3566,597 @@ void CHeaderView::mousePressEvent(QMouseEvent *e)
                 if (span.canConvert<uint>())
                     lastSection = index.column()+qBound(1,span.value<int>(),count()-index.column())-1;
 
-                QModelIndex index1 = orientation()==Qt::Horizontal? cmodel->index(0,firstSection,rootIndex()):
-                                                                    cmodel->index(firstSection,0,rootIndex()),
-                        index2 = orientation()==Qt::Horizontal? cmodel->index(model()->rowCount()-1,lastSection,rootIndex()):
-                                                                cmodel->index(lastSection,model()->columnCount()-1,rootIndex());
+                QModelIndex index1 = orientation()==Qt::Horizontal? model()->index(0,firstSection,rootIndex()):
+                                                                    model()->index(firstSection,0,rootIndex()),
+                        index2 = orientation()==Qt::Horizontal? model()->index(model()->rowCount()-1,lastSection,rootIndex()):
+                                                                model()->index(lastSection,model()->columnCount()-1,rootIndex());
                 selectionModel()->select(QItemSelection(index1, index2), QItemSelectionModel::ClearAndSelect);
             }
         }
     }
 }
 
+//   :       
+void CHeaderView::mouseMoveEvent(QMouseEvent *e)
+{
+    QHeaderView::mouseMoveEvent(e);
+    if (hoverMode)
+        setHoverCell(e->buttons() == Qt::NoButton? IndexAt(e->pos()) : QModelIndex());
+}
+//   ,   :   
+// ,  ,      .
+//          :
+//    QHeaderView        .
+//         sectionResized
+// (      ),   
+// ResizeToContents     QHeaderView
+void CHeaderView::setGroupCollapsed(int row, int column, bool collapsed)
+{
+    CHeaderModel *cmodel = headerModel.data();
+    if (!cmodel)
+        return;
+    QModelIndex index = cmodel->headerIndex(orientation(),row,column);
+    if (!index.isValid())
+        return;
+
+    int lastSection, lastLevel;
+    cellSpan(cmodel, index, lastSection, lastLevel);
+
+    bool updates = updatesEnabled(),
+         changed = false;
+    setUpdatesEnabled(false);
+    for (int section = index.column()+1; section <= lastSection; ++section)
+        if (isSectionHidden(section) != collapsed)
+        {
+            setSectionHidden(section, collapsed);
+            changed = true;
+        }
+    setUpdatesEnabled(updates);
+
+    if (!changed)
+        return;
+    //         
+    clearSectionHints(index.column(), lastSection);
+    viewport()->update();
+}
+//  ,     ,  
+bool CHeaderView::isGroupCollapsed(int row, int column) const
+{
+    CHeaderModel *cmodel = headerModel.data();
+    if (!cmodel)
+        return false;
+    QModelIndex index = cmodel->headerIndex(orientation(),row,column);
+    if (!index.isValid())
+        return false;
+
+    int lastSection, lastLevel;
+    cellSpan(cmodel, index, lastSection, lastLevel);
+    return lastSection > index.column() && !isSectionHidden(index.column()) &&
+           visibleSectionCount(index.column(), lastSection) == 1;
+}
+//      
+int CHeaderView::visibleSectionCount(int first, int last) const
+{
+    if (hiddenSectionCount() == 0)
+        return last-first+1;
+
+    int visible = 0;
+    for (int section = first; section <= last; ++section)
+        if (!isSectionHidden(section))
+            ++visible;
+    return visible;
+}
+//   ()   .   
+//   ,    
+void CHeaderView::setHoverHighlight(bool enabled)
+{
+    if (hoverMode == enabled)
+        return;
+    hoverMode = enabled;
+    if (enabled)
+    {
+        hoverTracking = viewport()->hasMouseTracking();
+        viewport()->setMouseTracking(true);
+    }
+    else
+    {
+        setHoverCell(QModelIndex());
+        viewport()->setMouseTracking(hoverTracking);
+    }
+}
+
+bool CHeaderView::hoverHighlight() const
+{
+    return hoverMode;
+}
+//   :   ,  
+//   ,     .   
+//  ,       
+//    
+void CHeaderView::setLabelPinning(bool enabled)
+{
+    if (pinningMode == enabled)
+        return;
+    pinningMode   = enabled;
+    paintedOffset = offset();
+    viewport()->update();
+}
+
+bool CHeaderView::labelPinning() const
+{
+    return pinningMode;
+}
+//  :      , 
+// -     (  ,   ,
+//   ).       . 
+//      :   ,
+//        ,  
+//  ,     . 0  ,
+//    
+void CHeaderView::setLayoutSource(CHeaderView *source)
+{
+    //     
+    for (CHeaderView *view = source; view; view = view->linkedView.data())
+        if (view == this)
+        {
+            source = 0;
+            break;
+        }
+
+    if (linkedView == source)
+        return;
+    //           
+    if (linkedView)
+    {
+        disconnect(linkedView, SIGNAL(headerLayoutUpdated()), this, SLOT(linkedLayoutUpdated()));
+        sharedLayout.detach();
+    }
+    linkedView = source;
+    if (linkedView)
+    {
+        connect(linkedView, SIGNAL(headerLayoutUpdated()), this, SLOT(linkedLayoutUpdated()));
+        linkedLayoutUpdated();
+    }
+}
+
+CHeaderView *CHeaderView::layoutSource() const
+{
+    return linkedView;
+}
+//   true,         
+//  ,   
+bool CHeaderView::linkedLayoutMatches(int levels, int sections) const
+{
+    CHeaderView *source = linkedView.data();
+    return source && source->orientation() == orientation() && source->levelCount == levels &&
+           source->layoutMatchesModel(sections) && source->font() == font() && source->style() == style();
+}
+//       (  ).
+//  true,       
+bool CHeaderView::adoptLinkedLayout(int levels, int sections)
+{
+    if (!linkedLayoutMatches(levels, sections))
+        return false;
+
+    CHeaderView *source = linkedView.data();
+    if (sharedLayout != source->sharedLayout)
+    {
+        sharedLayout   = source->sharedLayout;
+        layoutRevision = sharedLayout->revision;
+        sectionHint    = source->sectionHint;
+    }
+    levelCount = levels;
+    return true;
+}
+//    :    
+//       
+void CHeaderView::linkedLayoutUpdated()
+{
+    CHeaderModel *cmodel = headerModel.data();
+    if (!cmodel || !adoptLinkedLayout(cmodel->headerCount(orientation()), modelSectionCount()))
+        return;
+
+    resizeSections();
+    updateLevels();
+}
+//    .         
+//  ,        .
+//     ,   -  
+QModelIndexList CHeaderView::findCells(const QString &text, Qt::MatchFlags flags) const
+{
+    QModelIndexList cells;
+    CHeaderModel *cmodel = headerModel.data();
+    if (!cmodel || text.isEmpty())
+        return cells;
+    if (!searchIndexMatches(cmodel))
+        buildSearchIndex(cmodel);
+
+    bool caseSensitive = flags & Qt::MatchCaseSensitive;
+    const QVector<QString> &labels = caseSensitive? searchLabels : searchFolded;
+    QString pattern = caseSensitive? text : text.toCaseFolded();
+    uint matchType  = flags & 0x0F;
+
+    QBitArray matched(labels.size());
+    bool found = false;
+    if (caseSensitive && (matchType == Qt::MatchExactly || matchType == Qt::MatchFixedString))
+    {
+        int id = searchIds.value(pattern, -1);
+        if (id >= 0)
+        {
+            matched.setBit(id);
+            found = true;
+        }
+    }
+    else
+    {
+        for (int id = 0; id < labels.size(); ++id)
+        {
+            if (searchRefs.at(id) == 0)
+                continue;
+            const QString &label = labels.at(id);
+            bool match;
+            switch (matchType)
+            {
+            case Qt::MatchExactly:
+            case Qt::MatchFixedString:
+                match = label == pattern;
+                break;
+            case Qt::MatchStartsWith:
+                match = label.startsWith(pattern);
+                break;
+            case Qt::MatchEndsWith:
+                match = label.endsWith(pattern);
+                break;
+            default:
+                match = label.contains(pattern);
+            }
+            if (match)
+            {
+                matched.setBit(id);
+                found = true;
+            }
+        }
+    }
+    if (!found)
+        return cells;
+
+    int levels   = searchCells.size(),
+        sections = levels? searchCells.at(0).size() : 0;
+    QVarLengthArray<const int *, 16> rows(levels);
+    for (int row = 0; row < levels; ++row)
+        rows[row] = searchCells.at(row).constData();
+    for (int col = 0; col < sections; ++col)
+        for (int row = 0; row < levels; ++row)
+        {
+            int id = rows[row][col];
+            if (id >= 0 && matched.testBit(id))
+                cells.append(cmodel->headerIndex(orientation(), row, col));
+        }
+    return cells;
+}
+//   :     ,     
+//    .     
+void CHeaderView::scrollToCell(const QModelIndex &index)
+{
+    CHeaderModel *cmodel = headerModel.data();
+    QModelIndex cell;
+    if (cmodel && index.isValid())
+        cell = cmodel->headerIndex(orientation(), index.row(), index.column());
+    if (!cell.isValid())
+    {
+        setHighlightCell(-1, -1);
+        return;
+    }
+
+    int lastSection, lastLevel;
+    cellSpan(cmodel, cell, lastSection, lastLevel);
+    int section = cell.column();
+    while (section < lastSection && isSectionHidden(section))
+        ++section;
+
+    if (!isSectionHidden(section))
+    {
+        int start  = sectionViewportPosition(section),
+            end    = sectionViewportPosition(lastSection)+sectionSize(lastSection),
+            length = orientation() == Qt::Horizontal? viewport()->width() : viewport()->height();
+        if (qMin(start, end) < 0 || qMax(start, end) > length)
+        {
+            //      
+            QAbstractItemView *view = qobject_cast<QAbstractItemView *>(parentWidget());
+            if (view)
+            {
+                bool horizontal = orientation() == Qt::Horizontal;
+                QScrollBar *bar = horizontal? view->horizontalScrollBar() : view->verticalScrollBar();
+                QAbstractItemView::ScrollMode mode = horizontal? view->horizontalScrollMode() :
+                                                                 view->verticalScrollMode();
+                bar->setValue(mode == QAbstractItemView::ScrollPerItem? visualIndex(section) :
+                                                                        sectionPosition(section));
+            }
+            else
+                setOffsetToSectionPosition(visualIndex(section));
+        }
+    }
+    setHighlightCell(cell.row(), cell.column());
+}
+
+QModelIndex CHeaderView::highlightedCell() const
+{
+    CHeaderModel *cmodel = headerModel.data();
+    if (!cmodel || highlightRow < 0)
+        return QModelIndex();
+    return cmodel->headerIndex(orientation(), highlightRow, highlightColumn);
+}
+//    ,      
+bool CHeaderView::searchIndexMatches(CHeaderModel *cmodel) const
+{
+    return searchValid && searchCells.size() == cmodel->headerCount(orientation()) &&
+           (searchCells.isEmpty() || searchCells.at(0).size() == modelSectionCount());
+}
+//   :        
+void CHeaderView::buildSearchIndex(CHeaderModel *cmodel) const
+{
+    clearSearchIndex();
+    int levels   = cmodel->headerCount(orientation()),
+        sections = modelSectionCount();
+    searchCells.fill(QVector<int>(sections, -1), levels);
+    for (int row = 0; row < levels; ++row)
+        for (int col = 0; col < sections; ++col)
+            setSearchLabel(cmodel, row, col);
+    searchValid = true;
+}
+
+void CHeaderView::clearSearchIndex() const
+{
+    searchValid = false;
+    searchLabels.clear();
+    searchFolded.clear();
+    searchRefs.clear();
+    searchFree.clear();
+    searchIds.clear();
+    searchCells.clear();
+}
+//       ,    
+//      (   )
+void CHeaderView::updateSearchRange(CHeaderModel *cmodel, int first, int last)
+{
+    if (!searchValid)
+        return;
+    if (!searchIndexMatches(cmodel))
+    {
+        clearSearchIndex();
+        return;
+    }
+    first = qMax(first, 0);
+    last  = qMin(last, modelSectionCount()-1);
+    if (first > last)
+        return;
+
+    for (int row = 0; row < searchCells.size(); ++row)
+    {
+        int from = first,
+            to   = last;
+        QModelIndex index = cmodel->headerIndex(orientation(),row,first);
+        if (index.isValid())
+            from = qMin(from, index.column());
+        index = cmodel->headerIndex(orientation(),row,last);
+        if (index.isValid())
+        {
+            int lastSection, lastLevel;
+            cellSpan(cmodel, index, lastSection, lastLevel);
+            to = qMax(to, lastSection);
+        }
+        for (int col = from; col <= to; ++col)
+            setSearchLabel(cmodel, row, col);
+    }
+}
+//           
+//        
+void CHeaderView::insertSearchSections(CHeaderModel *cmodel, int first, int last)
+{
+    if (!searchValid)
+        return;
+    int inserted = last-first+1;
+    if (searchCells.size() != cmodel->headerCount(orientation()) ||
+        (!searchCells.isEmpty() && searchCells.at(0).size()+inserted != modelSectionCount()))
+    {
+        clearSearchIndex();
+        return;
+    }
+
+    for (int row = 0; row < searchCells.size(); ++row)
+        searchCells[row].insert(first, inserted, -1);
+    updateSearchRange(cmodel, first, last);
+}
+
+void CHeaderView::removeSearchSections(CHeaderModel *cmodel, int first, int last)
+{
+    if (!searchValid)
+        return;
+    int removed = last-first+1;
+    if (searchCells.size() != cmodel->headerCount(orientation()) ||
+        (!searchCells.isEmpty() && searchCells.at(0).size()-removed != modelSectionCount()))
+    {
+        clearSearchIndex();
+        return;
+    }
+
+    for (int row = 0; row < searchCells.size(); ++row)
+    {
+        QVector<int> &cells = searchCells[row];
+        for (int col = first; col <= last; ++col)
+            if (cells.at(col) >= 0)
+                releaseSearchLabel(cells.at(col));
+        cells.remove(first, removed);
+    }
+    updateSearchRange(cmodel, first-1, first);
+}
+
+void CHeaderView::moveSearchSections(CHeaderModel *cmodel, int start, int end, int section)
+{
+    if (!searchValid)
+        return;
+    if (!searchIndexMatches(cmodel))
+    {
+        clearSearchIndex();
+        return;
+    }
+    int count    = end-start+1,
+        newStart = section > end? section-count : section;
+    if (newStart == start)
+        return;
+
+    for (int row = 0; row < searchCells.size(); ++row)
+    {
+        QVector<int> &cells = searchCells[row];
+        if (section > end)
+            std::rotate(cells.begin()+start, cells.begin()+end+1, cells.begin()+section);
+        else
+            std::rotate(cells.begin()+section, cells.begin()+start, cells.begin()+end+1);
+    }
+
+    int gap = section > end? start : end+1;
+    updateSearchRange(cmodel, gap-1, gap);
+    updateSearchRange(cmodel, newStart-1, newStart+count);
+}
+//      :     ,
+//  ,       ,  
+void CHeaderView::setSearchLabel(CHeaderModel *cmodel, int row, int column) const
+{
+    int &id = searchCells[row][column];
+    if (id >= 0)
+        releaseSearchLabel(id);
+    id = -1;
+
+    QModelIndex index = cmodel->headerIndex(orientation(), row, column);
+    if (!index.isValid() || index.row() != row || index.column() != column)
+        return;
+    QString label = cmodel->headerData(index, orientation(), Qt::DisplayRole).toString();
+    if (label.isEmpty())
+        return;
+
+    QHash<QString,int>::const_iterator it = searchIds.constFind(label);
+    if (it != searchIds.constEnd())
+    {
+        id = it.value();
+        ++searchRefs[id];
+        return;
+    }
+    if (searchFree.isEmpty())
+    {
+        id = searchLabels.size();
+        searchLabels.append(label);
+        searchFolded.append(label.toCaseFolded());
+        searchRefs.append(1);
+    }
+    else
+    {
+        id = searchFree.takeLast();
+        searchLabels[id] = label;
+        searchFolded[id] = label.toCaseFolded();
+        searchRefs[id]   = 1;
+    }
+    searchIds.insert(label, id);
+}
+
+void CHeaderView::releaseSearchLabel(int id) const
+{
+    if (--searchRefs[id] > 0)
+        return;
+    searchIds.remove(searchLabels.at(id));
+    searchLabels[id].clear();
+    searchFolded[id].clear();
+    searchFree.append(id);
+}
+//   .     
+void CHeaderView::setStatisticsEnabled(bool enabled)
+{
+    statisticsMode = enabled;
+}
+
+bool CHeaderView::statisticsEnabled() const
+{
+    return statisticsMode;
+}
+
+CHeaderView::Statistics CHeaderView::statistics() const
+{
+    return stats;
+}
+
+void CHeaderView::resetStatistics()
+{
+    stats = Statistics();
+}
+//    ,   ,  
+//  (,        )
+QRect CHeaderView::spanRect(CHeaderModel *cmodel, int row, int column) const
+{
+    QModelIndex index = cmodel? cmodel->headerIndex(orientation(), row, column) : QModelIndex();
+    if (!index.isValid() || index.row() >= levelBottom.size())
+        return QRect();
+
+    int lastSection, lastLevel;
+    cellSpan(cmodel, index, lastSection, lastLevel);
+    return cellRect(index, lastSection, lastLevel);
+}
+//    .   
+//    
+void CHeaderView::setHoverCell(const QModelIndex &index)
+{
+    int row    = index.isValid()? index.row() : -1,
+        column = index.isValid()? index.column() : -1;
+    if (row == hoverRow && column == hoverColumn)
+        return;
+
+    CHeaderModel *cmodel = headerModel.data();
+    QRegion region;
+    //   ,     
+    if (hoverRow >= 0)
+        region += spanRect(cmodel, hoverRow, hoverColumn);
+
+    hoverRow    = row;
+    hoverColumn = column;
+
+    if (row >= 0)
+        region += spanRect(cmodel, row, column);
+    if (!region.isEmpty())
+        viewport()->update(region);
+}
+//  ,   
+bool CHeaderView::isHoverCell(const QModelIndex &index) const
+{
+    return hoverMode && !exportMode && index.row() == hoverRow && index.column() == hoverColumn;
+}
+//   ,  .     
+void CHeaderView::setHighlightCell(int row, int column)
+{
+    if (row == highlightRow && column == highlightColumn)
+        return;
+
+    CHeaderModel *cmodel = headerModel.data();
+    QRegion region;
+    if (highlightRow >= 0)
+        region += spanRect(cmodel, highlightRow, highlightColumn);
+
+    highlightRow    = row;
+    highlightColumn = column;
+
+    if (row >= 0)
+        region += spanRect(cmodel, row, column);
+    if (!region.isEmpty())
+        viewport()->update(region);
+}
+//  ,    
+bool CHeaderView::isHighlightCell(const QModelIndex &index) const
+{
+    return !exportMode && index.row() == highlightRow && index.column() == highlightColumn;
+}
+
 //    viewport.    
 //  IndexAt(),    
 bool CHeaderView::viewportEvent(QEvent *e)
 {
-    CHeaderModel *cmodel = dynamic_cast<CHeaderModel*>(model());
+    CHeaderModel *cmodel = headerModel.data();
 
     if (!cmodel)
         return QHeaderView::viewportEvent(e);
@@ -525,6 +4209,9 @@ bool CHeaderView::viewportEvent(QEvent *e)
             }
             return true; }
     #endif // QT_NO_STATUSTIP
+        case QEvent::Leave:
+            setHoverCell(QModelIndex());
+            break;
         default:
             return QHeaderView::viewportEvent(e);
         }
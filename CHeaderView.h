@@ -7,7 +7,18 @@
 
 #include <QHeaderView>
 #include <QVector>
-#include <QMap>
+#include <QCache>
+#include <QPixmap>
+#include <QBitArray>
+#include <QHash>
+#include <QBasicTimer>
+#include <QPointer>
+#include <QStringList>
+#include <QSharedData>
+
+class QFile;
+class QWindow;
+class QScreen;
 
 
 class CHeaderModel: public QAbstractTableModel
@@ -22,7 +33,38 @@ public:
         LevelSpanRole
     };
 
-    explicit CHeaderModel(QObject *parent = 0) : QAbstractTableModel(parent){}
+    //         
+    struct HeaderRoleData
+    {
+        int role;
+        QVariant data;
+    };
+    //       
+    struct HeaderSpan
+    {
+        int row;
+        int column;
+        int rowSpanCount;
+        int columnSpanCount;
+    };
+
+    //      (   )
+    struct HeaderStatistics
+    {
+        //      (headerData    headerMultiData)
+        QHash<int,qint64> dataRequests;
+        //   headerMultiData
+        qint64 multiDataCalls;
+        //   headerDataInternal  headerMultiDataInternal
+        qint64 internalCalls;
+        qint64 multiInternalCalls;
+        //     
+        qint64 spanLookups;
+
+        HeaderStatistics(): multiDataCalls(0), internalCalls(0), multiInternalCalls(0), spanLookups(0){}
+    };
+
+    explicit CHeaderModel(QObject *parent = 0);
     ~CHeaderModel();
     //     
     virtual int headerCount(Qt::Orientation orientation) const = 0;
@@ -30,29 +72,282 @@ public:
     //     ,  headerDataInternal
     QVariant headerData(const QModelIndex &index, Qt::Orientation orientation,
                                 int role = Qt::DisplayRole) const;
+    //           
+    // ( QAbstractItemModel::multiData() Qt 6)
+    void headerMultiData(const QModelIndex &index, Qt::Orientation orientation,
+                         HeaderRoleData *roleData, int count) const;
     //      
     QModelIndex headerIndex(Qt::Orientation orientation, int row, int column, const QModelIndex &parent = QModelIndex()) const;
-    //     
+    //      (    )
     void headerSpan(Qt::Orientation orientation, int row, int column, int rowSpanCount, int columnSpanCount);
+    //          
+    // (       )
+    void headerSetSpans(Qt::Orientation orientation, const QVector<HeaderSpan> &spans);
     //         
     void headerClear(Qt::Orientation orientation);
+    //    -   :  
+    //          .
+    //       (0 - )
+    void headerLinkSpans(Qt::Orientation orientation, CHeaderModel *source);
+    CHeaderModel *headerSpanSource(Qt::Orientation orientation) const;
+    // ,    ( )  
+    QByteArray headerSaveSpans(Qt::Orientation orientation) const;
+    bool headerRestoreSpans(Qt::Orientation orientation, const QByteArray &data);
+    bool headerCheckSpans(Qt::Orientation orientation, const QByteArray &data) const;
+    //    (, , ),  :
+    //      ,      .
+    // 0 -  
+    virtual quint32 headerContentVersion(Qt::Orientation orientation) const;
+    //        CHeaderView.
+    //       ,   
+    //  :          
+    //  . 0 -  ,      
+    virtual uint headerContentHash(Qt::Orientation orientation) const;
+    //       (  )
+    void headerSetStatisticsEnabled(bool enabled);
+    bool headerStatisticsEnabled() const;
+    HeaderStatistics headerStatistics() const;
+    void headerResetStatistics();
+signals:
+    //         
+    void headerSpanChanged(Qt::Orientation orientation, int first, int last);
+private slots:
+    //    ,  
+    void spanColumnsInserted(const QModelIndex &parent, int first, int last);
+    void spanColumnsRemoved(const QModelIndex &parent, int first, int last);
+    void spanColumnsMoved(const QModelIndex &parent, int start, int end, const QModelIndex &destination, int column);
+    void spanRowsInserted(const QModelIndex &parent, int first, int last);
+    void spanRowsRemoved(const QModelIndex &parent, int first, int last);
+    void spanRowsMoved(const QModelIndex &parent, int start, int end, const QModelIndex &destination, int row);
+    void linkedSpansChanged(Qt::Orientation orientation, int first, int last);
 protected:
     //        
     //      
     virtual QVariant headerDataInternal(const QModelIndex &index, Qt::Orientation orientation,
                                 int role = Qt::DisplayRole) const = 0;
+    //      (  ).
+    //    headerDataInternal   ,  
+    //  ,          
+    virtual void headerMultiDataInternal(const QModelIndex &index, Qt::Orientation orientation,
+                                         HeaderRoleData *roleData, int count) const;
+    //   ,  headerSaveSpans,  
+    //   ,    
+    static bool checkSpans(const QByteArray &data, int levelCount, int sections);
+    //     headerSaveSpans (  -  )
+    //    :    beginResetModel  endResetModel
+    bool headerResetSpans(Qt::Orientation orientation, const QByteArray &data = QByteArray());
+    //   ,    ,  
+    void headerReplaceSpans(Qt::Orientation orientation, int first, int last, const QVector<HeaderSpan> &spans);
+    //     ,     
+    //  ,     ()  
+    void headerInsertSections(Qt::Orientation orientation, int first, int count);
+    void headerRemoveSections(Qt::Orientation orientation, int first, int last);
+    void headerMoveSections(Qt::Orientation orientation, int start, int end, int destination);
+    //    (     )  headerContentHash
+    uint headerShapeHash(Qt::Orientation orientation) const;
 private:
-    //      
+    //      .
+    //       ,  
     struct Span
     {
-        QModelIndex parent;
+        //   ( )  
+        int row;
+        int column;
         int rowSpanCount;
         int columnSpanCount;
+
+        //   ,   (    )
+        int first() const { return column; }
+        int last() const { return column+columnSpanCount-1; }
+
+        bool operator==(const Span &other) const
+        {
+            return row == other.row && column == other.column &&
+                   rowSpanCount == other.rowSpanCount && columnSpanCount == other.columnSpanCount;
+        }
+    };
+    //     ,   first()
+    typedef QVector<Span> SpanLevel;
+    //    :      
+    //     .      
+    struct SpanIndex: public QSharedData
+    {
+        SpanIndex(): revision(0) {}
+
+        QVector<SpanLevel> levels;
+        int revision;
     };
-    //        (   )
-    QMap<QModelIndex,Span> horizontalSpan, verticalSpan;
+    //      
+    QExplicitlySharedDataPointer<SpanIndex> horizontalSpan, verticalSpan;
+    //    ,    (   )
+    int horizontalRevision, verticalRevision;
+    // -  
+    QPointer<CHeaderModel> horizontalLink, verticalLink;
     //         
     bool headerHasIndex(Qt::Orientation orientation,int row, int column, const QModelIndex &parent = QModelIndex()) const;
+    //     - (   )
+    void connectLink(CHeaderModel *link, bool connected);
+    //     :  ,   (
+    //      )      
+    // (0,       )
+    const QVector<SpanLevel> &spanLevels(Qt::Orientation orientation) const;
+    QVector<SpanLevel> &editableSpans(Qt::Orientation orientation);
+    QVector<SpanLevel> *shiftedSpans(Qt::Orientation orientation);
+    //   ,   (    )
+    const Span *findSpan(Qt::Orientation orientation, int row, int column) const;
+    //           
+    //      
+    static void insertSpan(QVector<SpanLevel> &levels, const Span &span, int &first, int &last);
+    static void removeSpan(QVector<SpanLevel> &levels, Span span);
+    static bool spanStartsAfter(int column, const Span &span);
+    static bool spanBefore(const Span &span, const Span &other);
+    //     ,    
+    static void insertSections(QVector<SpanLevel> &levels, int first, int count);
+    static void removeSections(QVector<SpanLevel> &levels, int first, int last);
+    static void moveSections(QVector<SpanLevel> &levels, int start, int end, int destination);
+    static bool removeFromSpan(Span &span, int first, int last);
+    static SpanLevel::iterator firstSpanFrom(SpanLevel &level, int column);
+    //      
+    static bool decodeSpans(const QByteArray &data, int levelCount, int sections,
+                            QVector<SpanLevel> &result, int &first, int &last);
+    //     
+    bool statisticsMode;
+    mutable HeaderStatistics stats;
+};
+
+
+// CHeaderProxyAdapter -    CHeaderView,  -
+// (QSortFilterProxyModel    QAbstractProxyModel,    )
+//  CHeaderModel.      , 
+//    -    .
+//   CHeaderView   
+class CHeaderProxyAdapter: public CHeaderModel
+{
+    Q_OBJECT
+
+public:
+    CHeaderProxyAdapter(Qt::Orientation orientation, QAbstractItemModel *proxy, CHeaderModel *source,
+                        QObject *parent = 0);
+    //        - (0 -  )
+    static CHeaderModel *findHeaderSource(QAbstractItemModel *model);
+    CHeaderModel *headerSource() const;
+    //   -    (-1 -  )
+    int mapSectionToSource(int section) const;
+    int mapSectionFromSource(int section) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    int headerCount(Qt::Orientation orientation) const;
+    uint headerContentHash(Qt::Orientation orientation) const;
+protected:
+    QVariant headerDataInternal(const QModelIndex &index, Qt::Orientation orientation,
+                                int role = Qt::DisplayRole) const;
+    void headerMultiDataInternal(const QModelIndex &index, Qt::Orientation orientation,
+                                 HeaderRoleData *roleData, int count) const;
+private slots:
+    //   -,     
+    void proxySectionsInserted(const QModelIndex &parent, int first, int last);
+    void proxySectionsRemoved(const QModelIndex &parent, int first, int last);
+    void proxySectionsMoved(const QModelIndex &parent, int start, int end, const QModelIndex &destination, int section);
+    void proxyLayoutChanged(const QList<QPersistentModelIndex> &parents, QAbstractItemModel::LayoutChangeHint hint);
+    void proxyReset();
+    void proxyItemsChanged();
+    void sourceSectionsInserted(const QModelIndex &parent, int first, int last);
+    void sourceSectionsRemoved(const QModelIndex &parent, int first, int last);
+    void sourceSectionsMoved(const QModelIndex &parent, int start, int end, const QModelIndex &destination, int section);
+    void sourceSpansChanged(Qt::Orientation orientation, int first, int last);
+private:
+    Qt::Orientation headerOrientation;
+    QPointer<QAbstractItemModel> proxy;
+    QPointer<CHeaderModel> source;
+    //      -   
+    QVector<int> toSource;
+    QVector<int> fromSource;
+    //      - (   )
+    bool mappedByItems;
+
+    void rebuild(bool notify);
+    void rebuildMap();
+    int mapSection(int section) const;
+    void rebuildSpans(bool notify);
+    void updateSpans(int first, int last, bool notify);
+    bool sameSourceCell(int row, int section, int other) const;
+    QVector<HeaderSpan> collectSpans(int first, int last) const;
+    QModelIndex sourceCell(const QModelIndex &index) const;
+};
+
+
+// CHeaderStringModel -         :
+//     ,      
+//   .     ,   
+// (   ).    CHeaderModel
+class CHeaderStringModel: public CHeaderModel
+{
+    Q_OBJECT
+
+public:
+    explicit CHeaderStringModel(Qt::Orientation orientation = Qt::Horizontal, QObject *parent = 0);
+    ~CHeaderStringModel();
+    //      (,     )
+    void setHeaderSize(int levels, int sections);
+    //   .      
+    //    setHeaderSize    (   )
+    void setHeaderLabel(int level, int section, const QString &label);
+    QString headerLabel(int level, int section) const;
+    //   ,    first
+    void setHeaderLabels(int level, int first, const QStringList &labels);
+    //      (   )
+    void setItemCount(int count);
+    int itemCount() const;
+    //     ,  
+    int stringCount() const;
+    //   (  )        
+    bool saveHeaderFile(const QString &fileName) const;
+    bool loadHeaderFile(const QString &fileName);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    int headerCount(Qt::Orientation orientation) const;
+    uint headerContentHash(Qt::Orientation orientation) const;
+protected:
+    QVariant headerDataInternal(const QModelIndex &index, Qt::Orientation orientation,
+                                int role = Qt::DisplayRole) const;
+    void headerMultiDataInternal(const QModelIndex &index, Qt::Orientation orientation,
+                                 HeaderRoleData *roleData, int count) const;
+private:
+    //  : ,    .    
+    //  (strings+1 ),    ,   (UTF-16)
+    //   
+    struct FileHeader
+    {
+        quint32 magic;
+        quint32 version;
+        quint32 levels;
+        quint32 sections;
+        quint32 strings;
+        quint32 characters;
+        quint32 spansSize;
+        quint32 reserved;
+    };
+    enum { FileMagic = 0x54534843, FileVersion = 2 };
+
+    Qt::Orientation headerOrientation;
+    int levelCount;
+    int sectionCount;
+    int items;
+    //    ( 0 -  )     
+    QVector<QString> strings;
+    QHash<QString,quint32> stringIds;
+    //     :      
+    QVector<QVector<quint32> > ownIndex;
+    QVector<const quint32 *> levelIndex;
+    QFile *mappedFile;
+
+    quint32 stringId(const QString &label);
+    void detachIndex(int level);
+    void closeFile();
 };
 
 
@@ -66,22 +361,334 @@ public:
     void setSelectionModel(QItemSelectionModel *selectionModel);
     void doItemsLayout();
     void reset();
+    //        (0 -  )
+    void setCellCacheLimit(int kbytes);
+    int cellCacheLimit() const;
+    //     (      )
+    void setLazySizing(bool enabled);
+    bool lazySizing() const;
+    void setLazySizingMargin(int sections);
+    int lazySizingMargin() const;
+    void setEstimatedCellSize(const QSize &size);
+    QSize estimatedCellSize() const;
+    //           
+    void setParallelSizing(bool enabled);
+    bool parallelSizing() const;
+    //   :    ,  -
+    //      
+    void setProgressiveLayout(bool enabled);
+    bool progressiveLayout() const;
+    void setProgressiveSliceTime(int msecs);
+    int progressiveSliceTime() const;
+    bool isLayoutComplete() const;
+    //   ,   ,   
+    void setGroupCollapsed(int row, int column, bool collapsed);
+    bool isGroupCollapsed(int row, int column) const;
+    //    (,    )   .
+    // ,    ,    
+    QByteArray saveLayout() const;
+    bool restoreLayout(const QByteArray &data);
+    //    (  )  , PDF   
+    QSize exportSize() const;
+    void exportTile(QPainter *painter, int position, int length);
+    void exportHeader(QPainter *painter, int tileLength = 2048);
+    //   ()   
+    void setHoverHighlight(bool enabled);
+    bool hoverHighlight() const;
+    //    ,    ,    
+    void setLabelPinning(bool enabled);
+    bool labelPinning() const;
+    //   -    :
+    //           
+    void setLayoutSource(CHeaderView *source);
+    CHeaderView *layoutSource() const;
+    //        (Qt::MatchExactly, MatchFixedString,
+    // MatchStartsWith, MatchEndsWith, MatchContains, MatchCaseSensitive;  
+    //   MatchContains).      
+    //     
+    QModelIndexList findCells(const QString &text, Qt::MatchFlags flags = Qt::MatchStartsWith) const;
+    //         (  -  )
+    void scrollToCell(const QModelIndex &index);
+    QModelIndex highlightedCell() const;
+
+    //      (   ,
+    //   )
+    struct Statistics
+    {
+        //   cellSizeFromContents
+        qint64 cellSizeCalls;
+        //     initializeSections
+        qint64 layoutRuns;
+        qint64 layoutTime;
+        //      ,   
+        qint64 paintEvents;
+        qint64 paintTime;
+        qint64 cellsPainted;
+        //      
+        qint64 sizeCacheHits;
+        qint64 sizeCacheMisses;
+        //      
+        qint64 pixmapCacheHits;
+        qint64 pixmapCacheMisses;
+        //       
+        qint64 measureCacheHits;
+        qint64 measureCacheMisses;
+
+        Statistics(): cellSizeCalls(0), layoutRuns(0), layoutTime(0), paintEvents(0), paintTime(0),
+                      cellsPainted(0), sizeCacheHits(0), sizeCacheMisses(0), pixmapCacheHits(0),
+                      pixmapCacheMisses(0), measureCacheHits(0), measureCacheMisses(0){}
+    };
+    //   (  ).     
+    //     cheaderview.performance   debug
+    void setStatisticsEnabled(bool enabled);
+    bool statisticsEnabled() const;
+    Statistics statistics() const;
+    void resetStatistics();
+signals:
+    //       
+    void layoutCompleted();
+    //         (  )
+    void headerLayoutUpdated();
 protected:
   void initializeSections();
     QSize sectionSizeFromContents(int section) const;
     QSize cellSizeFromContents(const QModelIndex &index) const;
     void mousePressEvent(QMouseEvent *e);
+    void mouseMoveEvent(QMouseEvent *e);
     bool viewportEvent(QEvent *e);
+    bool event(QEvent *e);
+    void timerEvent(QTimerEvent *e);
+    void paintEvent(QPaintEvent *e);
+    void paintSection(QPainter *painter, const QRect &rect, int col) const;
+    //         viewport
+    QModelIndex IndexAt(const QPoint &pos) const;
+    QModelIndex IndexAt(int ax, int ay) const;
+private slots:
+    //   ,    
+    void headerCellsChanged(Qt::Orientation orientation, int first, int last);
+    void headerSpansChanged(Qt::Orientation orientation, int first, int last);
+    void headerSectionsInserted(const QModelIndex &parent, int first, int last);
+    void headerSectionsRemoved(const QModelIndex &parent, int first, int last);
+    void headerSectionsMoved(const QModelIndex &parent, int start, int end, const QModelIndex &destination, int section);
+    void resizePendingSections();
+    void headerSelectionChanged(const QItemSelection &selected, const QItemSelection &deselected);
+    void invalidateSelection();
+    void headerLayoutChanged(const QList<QPersistentModelIndex> &parents, QAbstractItemModel::LayoutChangeHint hint);
+    void linkedLayoutUpdated();
+    void headerScreenChanged();
 private:
+    //  :     -
+    // (     )
+    QPointer<CHeaderModel> headerModel;
+    CHeaderProxyAdapter *proxyAdapter;
+    //     
+    struct LevelLayout
+    {
+        //   (    )
+        QVector<QSize> cellSize;
+        //       
+        QVector<int> cellExtent;
+        //   (  )
+        int size;
+        //     :   ,  
+        //     (0 -   )
+        int restoredSize;
+    };
     //   
     mutable QVector <int> levelBottom;
     //    
     mutable int levelCount;
+    //      (-1 -    )
+    QVector<int> sectionHint;
 
-    QModelIndex IndexAt(const QPoint &pos) const;
-    QModelIndex IndexAt(int ax, int ay) const;
+    //    :    ,
+    //   ,     
+    struct CellKey
+    {
+        int row;
+        int column;
+        int lastSection;
+        int width;
+        int height;
+        int state;
+        int dpr;
 
-    void paintSection(QPainter *painter, const QRect &rect, int col) const;
+        bool operator==(const CellKey &other) const
+        {
+            return row == other.row && column == other.column && lastSection == other.lastSection &&
+                   width == other.width && height == other.height && state == other.state && dpr == other.dpr;
+        }
+        friend uint qHash(const CellKey &key, uint seed = 0)
+        {
+            seed = qHash(key.row, qHash(key.column, seed));
+            seed = qHash(key.lastSection, qHash(key.width, qHash(key.height, seed)));
+            return qHash(key.state, qHash(key.dpr, seed));
+        }
+    };
+    //   ,   -    
+    mutable QCache<CellKey,QPixmap> cellCache;
+
+    //   ,        
+    bool lazySizingMode;
+    int lazyMargin;
+    QSize cellSizeEstimate;
+    //    ResizeToContents,     
+    QVector<int> pendingSections;
+
+    //   : ,       
+    struct MeasureKey
+    {
+        QString text;
+        QFont font;
+        QSize iconSize;
+        bool rotated;
+        bool sortIndicator;
+        // ,    (   )
+        const QStyle *style;
+
+        bool operator==(const MeasureKey &other) const
+        {
+            return text == other.text && iconSize == other.iconSize && rotated == other.rotated &&
+                   sortIndicator == other.sortIndicator && style == other.style && font == other.font;
+        }
+        friend uint qHash(const MeasureKey &key, uint seed = 0)
+        {
+            seed = qHash(key.text, qHash(key.font.key(), seed));
+            seed = qHash(key.iconSize.width(), qHash(key.iconSize.height(), seed));
+            seed = qHash(key.rotated, qHash(key.sortIndicator, seed));
+            return qHash(key.style, seed);
+        }
+    };
+    //  :     ,    
+    // (    )      
+    // .      
+    struct SharedLayout: public QSharedData
+    {
+        SharedLayout(): revision(0) {}
+
+        QVector<LevelLayout> levels;
+        QHash<MeasureKey,QSize> measureCache;
+        int revision;
+    };
+    QExplicitlySharedDataPointer<SharedLayout> sharedLayout;
+    //   ,   
+    int layoutRevision;
+    // ,      
+    QPointer<QWindow> screenWindow;
+
+    //   :  ,    ,
+    //       
+    bool progressiveMode;
+    QBasicTimer progressiveTimer;
+    int progressiveSlice;
+    int progressiveNext;
+    int progressiveSlices;
+
+    //    
+    bool parallelSizingMode;
+    //  ,    ,      
+    struct CellContents
+    {
+        MeasureKey key;
+        QVector<QPoint> targets;
+        //   (   )
+        QSize textSize;
+    };
+    static void measureCellText(CellContents &cell);
+
+    //         (-1 -  )
+    bool hoverMode;
+    int hoverRow;
+    int hoverColumn;
+    //       
+    bool hoverTracking;
+
+    //   ,   scrollToCell (-1 -  )
+    int highlightRow;
+    int highlightColumn;
+
+    //   :        ,
+    //         ,  
+    //    (-1 -       )
+    mutable bool searchValid;
+    mutable QVector<QString> searchLabels;
+    mutable QVector<QString> searchFolded;
+    mutable QVector<int> searchRefs;
+    mutable QVector<int> searchFree;
+    mutable QHash<QString,int> searchIds;
+    mutable QVector<QVector<int> > searchCells;
+
+    //    
+    QPointer<CHeaderView> linkedView;
+
+    //         
+    bool pinningMode;
+    int paintedOffset;
+
+    //         
+    mutable QBitArray sectionSelected;
+    mutable bool selectionDirty;
+
+    //     
+    bool statisticsMode;
+    mutable Statistics stats;
+    //     (   )
+    bool exportMode;
+    //      
+    enum { LayoutMagic = 0x43484c53, LayoutVersion = 3 };
+    //  ,   
+    QByteArray pendingLayout;
+
+    int modelSectionCount() const;
+    QSize cachedCellSize(const QModelIndex &index) const;
+    QSize knownCellSize(const QModelIndex &index) const;
+    bool deferredSizing() const;
+    bool layoutMatchesModel(int sections) const;
+    void measureSections(int first, int last);
+    bool measureSectionRange(CHeaderModel *cmodel, int first, int last, bool &changed);
+    void applyMeasuredSections(bool changed, bool resizePending);
+    void measureCellsParallel(CHeaderModel *cmodel, int first, int last);
+    QSize adjustedCellSize(QSize size, bool rotated, int margin) const;
+    bool cellMeasureKey(CHeaderModel *cmodel, const QModelIndex &index, int iconExtent,
+                        MeasureKey &key, QIcon &icon, QSize &size) const;
+    bool updateLevelCells(CHeaderModel *cmodel, int row, int first, int last);
+    bool updateSectionRange(CHeaderModel *cmodel, int first, int last);
+    int visibleSectionCount(int first, int last) const;
+    bool updateLevelBottom();
+    void updateLevels();
+    void invalidateLayout();
+    void clearSectionHints(int first, int last);
+    void watchScreen();
+    bool applyLayout(CHeaderModel *cmodel, const QByteArray &data);
+    bool linkedLayoutMatches(int levels, int sections) const;
+    bool beginLayoutChange();
+    bool adoptLinkedLayout(int levels, int sections);
+    uint layoutFingerprint(CHeaderModel *cmodel) const;
+
+    int paintCells(QPainter *painter, CHeaderModel *cmodel, int start, int end) const;
+    void paintCell(QPainter *painter, const QModelIndex &index, int section) const;
+    void drawCell(QPainter *painter, const QModelIndex &index, int section, const QRect &rect,
+                  const QRect &labelRect, bool selected) const;
+    QRect pinnedLabelRect(const QRect &rect) const;
+    QRegion pinnedCellsRegion(CHeaderModel *cmodel, int delta) const;
+    void removeCachedCells(int first, int last);
+    void cellSpan(CHeaderModel *cmodel, const QModelIndex &index, int &lastSection, int &lastLevel) const;
+    QRect cellRect(const QModelIndex &index, int lastSection, int lastLevel) const;
+    QRect spanRect(CHeaderModel *cmodel, int row, int column) const;
+    void setHoverCell(const QModelIndex &index);
+    bool isHoverCell(const QModelIndex &index) const;
+    void setHighlightCell(int row, int column);
+    bool isHighlightCell(const QModelIndex &index) const;
+    bool searchIndexMatches(CHeaderModel *cmodel) const;
+    void buildSearchIndex(CHeaderModel *cmodel) const;
+    void updateSearchRange(CHeaderModel *cmodel, int first, int last);
+    void insertSearchSections(CHeaderModel *cmodel, int first, int last);
+    void removeSearchSections(CHeaderModel *cmodel, int first, int last);
+    void moveSearchSections(CHeaderModel *cmodel, int start, int end, int section);
+    void setSearchLabel(CHeaderModel *cmodel, int row, int column) const;
+    void releaseSearchLabel(int id) const;
+    void clearSearchIndex() const;
+    bool isSectionSelected(int section) const;
 };
 
 
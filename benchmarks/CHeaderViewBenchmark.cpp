@@ -0,0 +1,742 @@
+//    CHeaderView  CHeaderModel
+//   : QT_QPA_PLATFORM=offscreen ./CHeaderViewBenchmark -o results.xml,xml
+// (   -csv, -teamcity    QtTest)
+
+#include "CHeaderView.h"
+
+#include <QtTest>
+#include <QImage>
+#include <QPainter>
+#include <QMouseEvent>
+#include <QItemSelectionModel>
+#include <QSortFilterProxyModel>
+#include <QTemporaryDir>
+#include <QTableView>
+
+//        
+class BenchmarkModel: public CHeaderModel
+{
+public:
+    BenchmarkModel(int sections, int levels, QObject *parent = 0):
+        CHeaderModel(parent), sections(sections), levels(levels){}
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const
+    {
+        return parent.isValid()? 0 : 16;
+    }
+    int columnCount(const QModelIndex &parent = QModelIndex()) const
+    {
+        return parent.isValid()? 0 : sections;
+    }
+    QVariant data(const QModelIndex &, int) const
+    {
+        return QVariant();
+    }
+    int headerCount(Qt::Orientation orientation) const
+    {
+        return orientation == Qt::Horizontal? levels : 1;
+    }
+protected:
+    QVariant headerDataInternal(const QModelIndex &index, Qt::Orientation, int role) const
+    {
+        if (role == Qt::DisplayRole)
+            return QString("L%1 S%2").arg(index.row()).arg(index.column());
+        return QVariant();
+    }
+private:
+    int sections;
+    int levels;
+};
+
+//       
+class BenchmarkHeaderView: public CHeaderView
+{
+public:
+    explicit BenchmarkHeaderView(QWidget *parent = 0): CHeaderView(Qt::Horizontal, parent){}
+
+    using CHeaderView::initializeSections;
+    using CHeaderView::sectionSizeFromContents;
+    using CHeaderView::paintSection;
+    using CHeaderView::IndexAt;
+    using CHeaderView::mousePressEvent;
+    using CHeaderView::mouseReleaseEvent;
+    using CHeaderView::mouseMoveEvent;
+};
+
+class CHeaderViewBenchmark: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void headerSpan_data();
+    void headerSpan();
+    void headerSetSpans_data();
+    void headerSetSpans();
+    void initializeSectionsCold_data();
+    void initializeSectionsCold();
+    void initializeSectionsParallel_data();
+    void initializeSectionsParallel();
+    void initializeSectionsProgressive_data();
+    void initializeSectionsProgressive();
+    void initializeSectionsProxy_data();
+    void initializeSectionsProxy();
+    void initializeSectionsLinked_data();
+    void initializeSectionsLinked();
+    void initializeSectionsWarm_data();
+    void initializeSectionsWarm();
+    void sectionSizeFromContents_data();
+    void sectionSizeFromContents();
+    void paintSection_data();
+    void paintSection();
+    void paintEvent_data();
+    void paintEvent();
+    void scrollStrip_data();
+    void scrollStrip();
+    void indexAt_data();
+    void indexAt();
+    void mousePressEvent_data();
+    void mousePressEvent();
+    void hoverMove_data();
+    void hoverMove();
+    void collapseGroup_data();
+    void collapseGroup();
+    void collapseWideGroup_data();
+    void collapseWideGroup();
+    void exportTiles_data();
+    void exportTiles();
+    void stringModelLoad_data();
+    void stringModelLoad();
+    void findCells_data();
+    void findCells();
+private:
+    static void addShapes();
+    static QVector<CHeaderModel::HeaderSpan> spanLayout(int sections, int levels, const QString &pattern);
+    static void setupSpans(CHeaderModel *model, int sections, int levels, const QString &pattern);
+};
+
+//  : 1k/10k/100k , 1/3/8 ,    
+void CHeaderViewBenchmark::addShapes()
+{
+    QTest::addColumn<int>("sections");
+    QTest::addColumn<int>("levels");
+    QTest::addColumn<QString>("pattern");
+
+    const int sections[] = {1000, 10000, 100000};
+    const int levels[]   = {1, 3, 8};
+    const char *patterns[] = {"dense", "sparse"};
+
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            for (int k = 0; k < 2; ++k)
+            {
+                QByteArray tag = QString("%1x%2/%3").arg(sections[i]).arg(levels[j]).arg(patterns[k]).toLatin1();
+                QTest::newRow(tag.constData()) << sections[i] << levels[j] << QString(patterns[k]);
+            }
+}
+
+//  :  ,  ,   ,
+//  4   ,    .
+//  :  64-       
+QVector<CHeaderModel::HeaderSpan> CHeaderViewBenchmark::spanLayout(int sections, int levels, const QString &pattern)
+{
+    QVector<CHeaderModel::HeaderSpan> spans;
+    CHeaderModel::HeaderSpan span;
+    if (pattern == "dense")
+    {
+        for (int row = 0; row < levels-1; ++row)
+        {
+            int width = 4;
+            for (int i = row; i < levels-2; ++i)
+                width = qMin(width*4, sections);
+            for (int col = 0; col < sections; col += width)
+            {
+                span.row = row;
+                span.column = col;
+                span.rowSpanCount = 1;
+                span.columnSpanCount = width;
+                spans.append(span);
+            }
+        }
+    }
+    else
+    {
+        for (int col = 0; col < sections; col += 64)
+        {
+            span.row = 0;
+            span.column = col;
+            span.rowSpanCount = qMin(2, levels);
+            span.columnSpanCount = 4;
+            spans.append(span);
+        }
+    }
+    return spans;
+}
+
+void CHeaderViewBenchmark::setupSpans(CHeaderModel *model, int sections, int levels, const QString &pattern)
+{
+    model->headerSetSpans(Qt::Horizontal, spanLayout(sections, levels, pattern));
+}
+
+void CHeaderViewBenchmark::headerSpan_data()
+{
+    addShapes();
+}
+
+//    
+void CHeaderViewBenchmark::headerSpan()
+{
+    QFETCH(int, sections);
+    QFETCH(int, levels);
+    QFETCH(QString, pattern);
+
+    BenchmarkModel model(sections, levels);
+    QVector<CHeaderModel::HeaderSpan> spans = spanLayout(sections, levels, pattern);
+    QBENCHMARK {
+        model.headerClear(Qt::Horizontal);
+        for (int i = 0; i < spans.size(); ++i)
+            model.headerSpan(Qt::Horizontal, spans.at(i).row, spans.at(i).column,
+                             spans.at(i).rowSpanCount, spans.at(i).columnSpanCount);
+    }
+}
+
+void CHeaderViewBenchmark::headerSetSpans_data()
+{
+    addShapes();
+}
+
+//   
+void CHeaderViewBenchmark::headerSetSpans()
+{
+    QFETCH(int, sections);
+    QFETCH(int, levels);
+    QFETCH(QString, pattern);
+
+    BenchmarkModel model(sections, levels);
+    QVector<CHeaderModel::HeaderSpan> spans = spanLayout(sections, levels, pattern);
+    QBENCHMARK {
+        model.headerSetSpans(Qt::Horizontal, spans);
+    }
+}
+
+void CHeaderViewBenchmark::initializeSectionsCold_data()
+{
+    addShapes();
+}
+
+//  :      
+void CHeaderViewBenchmark::initializeSectionsCold()
+{
+    QFETCH(int, sections);
+    QFETCH(int, levels);
+    QFETCH(QString, pattern);
+
+    BenchmarkModel model(sections, levels);
+    setupSpans(&model, sections, levels, pattern);
+
+    QBENCHMARK {
+        BenchmarkHeaderView view;
+        view.setModel(&model);
+    }
+}
+
+void CHeaderViewBenchmark::initializeSectionsParallel_data()
+{
+    addShapes();
+}
+
+//         
+void CHeaderViewBenchmark::initializeSectionsParallel()
+{
+    QFETCH(int, sections);
+    QFETCH(int, levels);
+    QFETCH(QString, pattern);
+
+    BenchmarkModel model(sections, levels);
+    setupSpans(&model, sections, levels, pattern);
+
+    QBENCHMARK {
+        BenchmarkHeaderView view;
+        view.setParallelSizing(true);
+        view.setModel(&model);
+    }
+}
+
+void CHeaderViewBenchmark::initializeSectionsProgressive_data()
+{
+    addShapes();
+}
+
+//  :      
+// (   ,  -    )
+void CHeaderViewBenchmark::initializeSectionsProgressive()
+{
+    QFETCH(int, sections);
+    QFETCH(int, levels);
+    QFETCH(QString, pattern);
+
+    BenchmarkModel model(sections, levels);
+    setupSpans(&model, sections, levels, pattern);
+
+    QBENCHMARK {
+        BenchmarkHeaderView view;
+        view.resize(800, 100);
+        view.setEstimatedCellSize(QSize(60, 20));
+        view.setProgressiveLayout(true);
+        view.setModel(&model);
+    }
+}
+
+void CHeaderViewBenchmark::initializeSectionsProxy_data()
+{
+    addShapes();
+}
+
+//    QSortFilterProxyModel (    -)
+void CHeaderViewBenchmark::initializeSectionsProxy()
+{
+    QFETCH(int, sections);
+    QFETCH(int, levels);
+    QFETCH(QString, pattern);
+
+    BenchmarkModel model(sections, levels);
+    setupSpans(&model, sections, levels, pattern);
+    QSortFilterProxyModel proxy;
+    proxy.setSourceModel(&model);
+
+    QBENCHMARK {
+        BenchmarkHeaderView view;
+        view.setModel(&proxy);
+    }
+}
+
+void CHeaderViewBenchmark::initializeSectionsLinked_data()
+{
+    addShapes();
+}
+
+//      :   
+//   ,        
+void CHeaderViewBenchmark::initializeSectionsLinked()
+{
+    QFETCH(int, sections);
+    QFETCH(int, levels);
+    QFETCH(QString, pattern);
+
+    enum { LinkedViews = 4 };
+    BenchmarkModel model(sections, levels);
+    setupSpans(&model, sections, levels, pattern);
+    BenchmarkHeaderView source;
+    source.setModel(&model);
+
+    QVector<BenchmarkModel *> models;
+    for (int i = 0; i < LinkedViews; ++i)
+    {
+        models.append(new BenchmarkModel(sections, levels));
+        models.last()->headerLinkSpans(Qt::Horizontal, &model);
+    }
+
+    QBENCHMARK {
+        for (int i = 0; i < LinkedViews; ++i)
+        {
+            BenchmarkHeaderView view;
+            view.setLayoutSource(&source);
+            view.setModel(models.at(i));
+        }
+    }
+    qDeleteAll(models);
+}
+
+void CHeaderViewBenchmark::initializeSectionsWarm_data()
+{
+    addShapes();
+}
+
+//      
+void CHeaderViewBenchmark::initializeSectionsWarm()
+{
+    QFETCH(int, sections);
+    QFETCH(int, levels);
+    QFETCH(QString, pattern);
+
+    BenchmarkModel model(sections, levels);
+    setupSpans(&model, sections, levels, pattern);
+    BenchmarkHeaderView view;
+    view.setModel(&model);
+
+    QBENCHMARK {
+        view.initializeSections();
+    }
+}
+
+void CHeaderViewBenchmark::sectionSizeFromContents_data()
+{
+    addShapes();
+}
+
+void CHeaderViewBenchmark::sectionSizeFromContents()
+{
+    QFETCH(int, sections);
+    QFETCH(int, levels);
+    QFETCH(QString, pattern);
+
+    BenchmarkModel model(sections, levels);
+    setupSpans(&model, sections, levels, pattern);
+    BenchmarkHeaderView view;
+    view.setModel(&model);
+
+    QBENCHMARK {
+        for (int section = 0; section < sections; ++section)
+            view.sectionSizeFromContents(section);
+    }
+}
+
+void CHeaderViewBenchmark::paintSection_data()
+{
+    addShapes();
+}
+
+//      paintSection  
+void CHeaderViewBenchmark::paintSection()
+{
+    QFETCH(int, sections);
+    QFETCH(int, levels);
+    QFETCH(QString, pattern);
+
+    BenchmarkModel model(sections, levels);
+    setupSpans(&model, sections, levels, pattern);
+    BenchmarkHeaderView view;
+    view.setModel(&model);
+    view.resize(1920, view.sizeHint().height());
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+
+    QImage image(view.size(), QImage::Format_ARGB32_Premultiplied);
+    int last = view.logicalIndexAt(view.width()-1);
+    if (last < 0)
+        last = view.count()-1;
+
+    QBENCHMARK {
+        QPainter painter(&image);
+        for (int section = view.logicalIndexAt(0); section <= last; ++section)
+        {
+            QRect rect(view.sectionViewportPosition(section), 0, view.sectionSize(section), view.height());
+            painter.save();
+            view.paintSection(&painter, rect, section);
+            painter.restore();
+        }
+    }
+}
+
+void CHeaderViewBenchmark::paintEvent_data()
+{
+    addShapes();
+}
+
+//    (paintEvent)  
+void CHeaderViewBenchmark::paintEvent()
+{
+    QFETCH(int, sections);
+    QFETCH(int, levels);
+    QFETCH(QString, pattern);
+
+    BenchmarkModel model(sections, levels);
+    setupSpans(&model, sections, levels, pattern);
+    BenchmarkHeaderView view;
+    view.setModel(&model);
+    view.resize(1920, view.sizeHint().height());
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+
+    QImage image(view.size(), QImage::Format_ARGB32_Premultiplied);
+
+    QBENCHMARK {
+        view.render(&image);
+    }
+}
+
+void CHeaderViewBenchmark::scrollStrip_data()
+{
+    addShapes();
+}
+
+//     4K   :   
+//   (    )
+void CHeaderViewBenchmark::scrollStrip()
+{
+    QFETCH(int, sections);
+    QFETCH(int, levels);
+    QFETCH(QString, pattern);
+
+    BenchmarkModel model(sections, levels);
+    setupSpans(&model, sections, levels, pattern);
+    BenchmarkHeaderView view;
+    view.setModel(&model);
+    view.setLabelPinning(true);
+    view.resize(3840, view.sizeHint().height());
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+
+    enum { Step = 16 };
+    QImage image(view.size(), QImage::Format_ARGB32_Premultiplied);
+    QRegion strip(QRect(view.width()-Step, 0, Step, view.height()));
+    int range = qMax(1, view.length()-view.width());
+
+    QBENCHMARK {
+        view.setOffset((view.offset()+Step) % range);
+        view.render(&image, QPoint(), strip);
+    }
+}
+
+void CHeaderViewBenchmark::indexAt_data()
+{
+    addShapes();
+}
+
+//            4 
+void CHeaderViewBenchmark::indexAt()
+{
+    QFETCH(int, sections);
+    QFETCH(int, levels);
+    QFETCH(QString, pattern);
+
+    BenchmarkModel model(sections, levels);
+    setupSpans(&model, sections, levels, pattern);
+    BenchmarkHeaderView view;
+    view.setModel(&model);
+    view.resize(1920, view.sizeHint().height());
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+
+    QBENCHMARK {
+        for (int y = 0; y < view.height(); y += 4)
+            for (int x = 0; x < view.width(); x += 4)
+                view.IndexAt(x, y);
+    }
+}
+
+void CHeaderViewBenchmark::mousePressEvent_data()
+{
+    addShapes();
+}
+
+//        
+void CHeaderViewBenchmark::mousePressEvent()
+{
+    QFETCH(int, sections);
+    QFETCH(int, levels);
+    QFETCH(QString, pattern);
+
+    BenchmarkModel model(sections, levels);
+    setupSpans(&model, sections, levels, pattern);
+    QItemSelectionModel selection(&model);
+    BenchmarkHeaderView view;
+    view.setModel(&model);
+    view.setSelectionModel(&selection);
+    view.resize(1920, view.sizeHint().height());
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+
+    QPoint pos(view.width()/2, 1);
+    QMouseEvent press(QEvent::MouseButtonPress, pos, Qt::LeftButton, Qt::LeftButton, Qt::NoModifier);
+    QMouseEvent release(QEvent::MouseButtonRelease, pos, Qt::LeftButton, Qt::NoButton, Qt::NoModifier);
+
+    QBENCHMARK {
+        view.mousePressEvent(&press);
+        view.mouseReleaseEvent(&release);
+    }
+    QVERIFY(selection.hasSelection());
+}
+
+void CHeaderViewBenchmark::hoverMove_data()
+{
+    addShapes();
+}
+
+//           
+void CHeaderViewBenchmark::hoverMove()
+{
+    QFETCH(int, sections);
+    QFETCH(int, levels);
+    QFETCH(QString, pattern);
+
+    BenchmarkModel model(sections, levels);
+    setupSpans(&model, sections, levels, pattern);
+    BenchmarkHeaderView view;
+    view.setModel(&model);
+    view.setHoverHighlight(true);
+    view.resize(3840, view.sizeHint().height());
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+
+    QBENCHMARK {
+        for (int x = 0; x < view.width(); x += 16)
+        {
+            QMouseEvent move(QEvent::MouseMove, QPoint(x, 1), Qt::NoButton, Qt::NoButton, Qt::NoModifier);
+            view.mouseMoveEvent(&move);
+        }
+    }
+}
+
+void CHeaderViewBenchmark::collapseGroup_data()
+{
+    addShapes();
+}
+
+//       
+void CHeaderViewBenchmark::collapseGroup()
+{
+    QFETCH(int, sections);
+    QFETCH(int, levels);
+    QFETCH(QString, pattern);
+
+    BenchmarkModel model(sections, levels);
+    setupSpans(&model, sections, levels, pattern);
+    BenchmarkHeaderView view;
+    view.setModel(&model);
+    view.resize(1920, view.sizeHint().height());
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+
+    QBENCHMARK {
+        view.setGroupCollapsed(0, 0, true);
+        view.setGroupCollapsed(0, 0, false);
+    }
+}
+
+void CHeaderViewBenchmark::collapseWideGroup_data()
+{
+    QTest::addColumn<int>("width");
+
+    const int widths[] = {1000, 10000, 50000};
+    for (int i = 0; i < 3; ++i)
+        QTest::newRow(QByteArray::number(widths[i]).constData()) << widths[i];
+}
+
+//          
+//  100000  (   sectionResized )
+void CHeaderViewBenchmark::collapseWideGroup()
+{
+    QFETCH(int, width);
+
+    BenchmarkModel model(100000, 2);
+    model.headerSpan(Qt::Horizontal, 0, 0, 1, width);
+    QTableView table;
+    BenchmarkHeaderView *view = new BenchmarkHeaderView(&table);
+    table.setHorizontalHeader(view);
+    table.setModel(&model);
+    table.resize(1920, 480);
+    table.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&table));
+
+    QBENCHMARK {
+        view->setGroupCollapsed(0, 0, true);
+        QCoreApplication::processEvents();
+        view->setGroupCollapsed(0, 0, false);
+        QCoreApplication::processEvents();
+    }
+    QVERIFY(!view->isGroupCollapsed(0, 0));
+}
+
+void CHeaderViewBenchmark::exportTiles_data()
+{
+    addShapes();
+}
+
+//      2048     
+void CHeaderViewBenchmark::exportTiles()
+{
+    QFETCH(int, sections);
+    QFETCH(int, levels);
+    QFETCH(QString, pattern);
+
+    BenchmarkModel model(sections, levels);
+    setupSpans(&model, sections, levels, pattern);
+    BenchmarkHeaderView view;
+    view.setModel(&model);
+    view.resize(1920, view.sizeHint().height());
+
+    const int tileLength = 2048;
+    QImage tile(tileLength, view.exportSize().height(), QImage::Format_ARGB32_Premultiplied);
+
+    QBENCHMARK {
+        for (int position = 0; position < view.length(); position += tileLength)
+        {
+            tile.fill(Qt::transparent);
+            QPainter painter(&tile);
+            view.exportTile(&painter, position, tileLength);
+        }
+    }
+}
+
+void CHeaderViewBenchmark::stringModelLoad_data()
+{
+    QTest::addColumn<int>("sections");
+    QTest::newRow("100k") << 100000;
+    QTest::newRow("1M")   << 1000000;
+}
+
+//    CHeaderStringModel     
+//     (     )
+void CHeaderViewBenchmark::stringModelLoad()
+{
+    QFETCH(int, sections);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString fileName = dir.path()+"/header.chs";
+    {
+        CHeaderStringModel model;
+        model.setHeaderSize(3, sections);
+        QStringList units;
+        units << "Min" << "Max" << "Avg" << "Sum";
+        for (int section = 0; section < sections; ++section)
+        {
+            model.setHeaderLabel(0, section, QString("Group %1").arg(section/64));
+            model.setHeaderLabel(1, section, QString("Item %1").arg(section/4%16));
+            model.setHeaderLabel(2, section, units.at(section%4));
+        }
+        QVERIFY(model.saveHeaderFile(fileName));
+    }
+
+    QBENCHMARK {
+        CHeaderStringModel model;
+        QVERIFY(model.loadHeaderFile(fileName));
+        BenchmarkHeaderView view;
+        view.resize(1920, 100);
+        view.setLazySizing(true);
+        view.setModel(&model);
+    }
+}
+
+void CHeaderViewBenchmark::findCells_data()
+{
+    addShapes();
+}
+
+//           (   ),
+//            
+void CHeaderViewBenchmark::findCells()
+{
+    QFETCH(int, sections);
+    QFETCH(int, levels);
+    QFETCH(QString, pattern);
+
+    BenchmarkModel model(sections, levels);
+    setupSpans(&model, sections, levels, pattern);
+    BenchmarkHeaderView view;
+    view.setModel(&model);
+    view.resize(1920, view.sizeHint().height());
+    QCOMPARE(view.findCells("L0 S0", Qt::MatchExactly).size(), 1);
+
+    QBENCHMARK {
+        QModelIndexList prefix   = view.findCells("L0 S9");
+        QModelIndexList contains = view.findCells("s77", Qt::MatchContains);
+        if (!contains.isEmpty())
+            view.scrollToCell(contains.last());
+        emit model.headerDataChanged(Qt::Horizontal, sections/2, sections/2);
+    }
+}
+
+QTEST_MAIN(CHeaderViewBenchmark)
+
+#include "CHeaderViewBenchmark.moc"
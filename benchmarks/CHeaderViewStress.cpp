@@ -0,0 +1,761 @@
+// -  CHeaderModel   CHeaderView   
+//        
+//   : QT_QPA_PLATFORM=offscreen ./CHeaderViewStress
+//  :
+//   CHEADERVIEW_STRESS_ITERATIONS  -      (40)
+//   CHEADERVIEW_STRESS_SEED        -     (1)
+//   CHEADERVIEW_BASELINES          -     
+//   CHEADERVIEW_RECORD_BASELINES=1 -       
+//   CHEADERVIEW_BASELINE_TOLERANCE -     (1.5)
+
+#include "CHeaderView.h"
+
+#include <QtTest>
+#include <QImage>
+#include <QPainter>
+#include <QProxyStyle>
+#include <QStyleOptionHeader>
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+
+//    (xorshift),      
+class StressRandom
+{
+public:
+    explicit StressRandom(quint32 seed): state(seed? seed : 1){}
+
+    //    [0, bound)
+    int bounded(int bound)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return bound > 0? int(state % quint32(bound)) : 0;
+    }
+    bool chance(int percent)
+    {
+        return bounded(100) < percent;
+    }
+private:
+    quint32 state;
+};
+
+//         .  ,
+//         
+class StressModel: public CHeaderModel
+{
+public:
+    StressModel(Qt::Orientation orientation, int levels, int sections, quint32 seed, QObject *parent = 0):
+        CHeaderModel(parent), orientation(orientation), random(seed), nextId(0), cells(levels)
+    {
+        for (int row = 0; row < levels; ++row)
+            for (int col = 0; col < sections; ++col)
+                cells[row].append(newCell(row));
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const
+    {
+        return parent.isValid()? 0 : (orientation == Qt::Vertical? sectionCount() : 4);
+    }
+    int columnCount(const QModelIndex &parent = QModelIndex()) const
+    {
+        return parent.isValid()? 0 : (orientation == Qt::Horizontal? sectionCount() : 4);
+    }
+    QVariant data(const QModelIndex &, int) const
+    {
+        return QVariant();
+    }
+    int headerCount(Qt::Orientation orientation) const
+    {
+        return orientation == this->orientation? cells.size() : 1;
+    }
+    int sectionCount() const
+    {
+        return cells.isEmpty()? 0 : cells.at(0).size();
+    }
+    //   (, )  
+    QHash<QString,QPoint> labelPositions() const
+    {
+        QHash<QString,QPoint> positions;
+        for (int row = 0; row < cells.size(); ++row)
+            for (int col = 0; col < cells.at(row).size(); ++col)
+                positions.insert(cells.at(row).at(col).label, QPoint(row, col));
+        return positions;
+    }
+    void insertHeaderSections(int first, int count)
+    {
+        if (orientation == Qt::Horizontal)
+            beginInsertColumns(QModelIndex(), first, first+count-1);
+        else
+            beginInsertRows(QModelIndex(), first, first+count-1);
+        for (int row = 0; row < cells.size(); ++row)
+            for (int i = 0; i < count; ++i)
+                cells[row].insert(first, newCell(row));
+        if (orientation == Qt::Horizontal)
+            endInsertColumns();
+        else
+            endInsertRows();
+    }
+    void removeHeaderSections(int first, int count)
+    {
+        if (orientation == Qt::Horizontal)
+            beginRemoveColumns(QModelIndex(), first, first+count-1);
+        else
+            beginRemoveRows(QModelIndex(), first, first+count-1);
+        for (int row = 0; row < cells.size(); ++row)
+            cells[row].remove(first, count);
+        if (orientation == Qt::Horizontal)
+            endRemoveColumns();
+        else
+            endRemoveRows();
+    }
+    //   [first, first+count)   destination
+    // (destination   ,   beginMoveColumns)
+    void moveHeaderSections(int first, int count, int destination)
+    {
+        int last = first+count-1;
+        bool moved = orientation == Qt::Horizontal?
+                     beginMoveColumns(QModelIndex(), first, last, QModelIndex(), destination) :
+                     beginMoveRows(QModelIndex(), first, last, QModelIndex(), destination);
+        if (!moved)
+            return;
+        int newStart = destination > last? destination-count : destination;
+        for (int row = 0; row < cells.size(); ++row)
+        {
+            QVector<Cell> block = cells.at(row).mid(first, count);
+            cells[row].remove(first, count);
+            for (int i = 0; i < count; ++i)
+                cells[row].insert(newStart+i, block.at(i));
+        }
+        if (orientation == Qt::Horizontal)
+            endMoveColumns();
+        else
+            endMoveRows();
+    }
+    //      
+    void relabel(int row, int section)
+    {
+        cells[row][section] = newCell(row);
+        emit headerDataChanged(orientation, section, section);
+    }
+protected:
+    QVariant headerDataInternal(const QModelIndex &index, Qt::Orientation orientation, int role) const
+    {
+        if (orientation != this->orientation)
+            return QVariant();
+        const Cell &cell = cells.at(index.row()).at(index.column());
+        if (role == Qt::DisplayRole)
+            return cell.label;
+        if (role == RotationRole)
+            return cell.rotated;
+        return QVariant();
+    }
+private:
+    struct Cell
+    {
+        QString label;
+        bool rotated;
+    };
+    Cell newCell(int row)
+    {
+        Cell cell;
+        cell.label = QString("%1.%2").arg(row).arg(nextId++);
+        if (random.chance(25))
+            cell.label += " "+QString(1+random.bounded(16), QChar('W'));
+        cell.rotated = random.chance(10);
+        return cell;
+    }
+
+    Qt::Orientation orientation;
+    StressRandom random;
+    int nextId;
+    QVector<QVector<Cell> > cells;
+};
+
+//   :     .
+// ,   ,  
+class ReferenceSpans
+{
+public:
+    ReferenceSpans(int levels, int sections): levels(levels), sections(sections), owner(levels*sections, -1){}
+
+    void add(CHeaderModel::HeaderSpan span)
+    {
+        if (span.row < 0 || span.row >= levels || span.column < 0 || span.column >= sections ||
+            span.rowSpanCount <= 0 || span.columnSpanCount <= 0)
+            return;
+        span.rowSpanCount    = qMin(span.rowSpanCount, levels-span.row);
+        span.columnSpanCount = qMin(span.columnSpanCount, sections-span.column);
+
+        int id = spans.size();
+        for (int row = span.row; row < span.row+span.rowSpanCount; ++row)
+            for (int col = span.column; col < span.column+span.columnSpanCount; ++col)
+                if (owner.at(row*sections+col) >= 0)
+                    clear(owner.at(row*sections+col));
+        for (int row = span.row; row < span.row+span.rowSpanCount; ++row)
+            for (int col = span.column; col < span.column+span.columnSpanCount; ++col)
+                owner[row*sections+col] = id;
+        spans.append(span);
+    }
+    // ,   (   -    )
+    CHeaderModel::HeaderSpan spanAt(int row, int column) const
+    {
+        int id = owner.at(row*sections+column);
+        if (id >= 0)
+            return spans.at(id);
+        CHeaderModel::HeaderSpan cell;
+        cell.row             = row;
+        cell.column          = column;
+        cell.rowSpanCount    = 1;
+        cell.columnSpanCount = 1;
+        return cell;
+    }
+private:
+    void clear(int id)
+    {
+        const CHeaderModel::HeaderSpan &span = spans.at(id);
+        for (int row = span.row; row < span.row+span.rowSpanCount; ++row)
+            for (int col = span.column; col < span.column+span.columnSpanCount; ++col)
+                if (owner.at(row*sections+col) == id)
+                    owner[row*sections+col] = -1;
+    }
+
+    int levels;
+    int sections;
+    QVector<int> owner;
+    QVector<CHeaderModel::HeaderSpan> spans;
+};
+
+// ,     (  )  
+//   . ,     , 
+//   
+class RecordingStyle: public QProxyStyle
+{
+public:
+    void drawControl(ControlElement element, const QStyleOption *option, QPainter *painter,
+                     const QWidget *widget = 0) const
+    {
+        const QStyleOptionHeader *header = qstyleoption_cast<const QStyleOptionHeader *>(option);
+        if (element == CE_HeaderSection && header)
+        {
+            QRect rect = painter->transform().mapRect(option->rect);
+            if (rects.contains(header->text) && rects.value(header->text) != rect)
+                conflicts.append(header->text);
+            rects.insert(header->text, rect);
+        }
+        if (element != CE_HeaderSection && element != CE_HeaderLabel)
+            QProxyStyle::drawControl(element, option, painter, widget);
+    }
+
+    mutable QHash<QString,QRect> rects;
+    mutable QStringList conflicts;
+};
+
+//         
+class StressHeaderView: public CHeaderView
+{
+public:
+    explicit StressHeaderView(Qt::Orientation orientation, QWidget *parent = 0): CHeaderView(orientation, parent){}
+
+    using CHeaderView::IndexAt;
+};
+
+class CHeaderViewStress: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void overlappingSpan();
+    void randomLayouts_data();
+    void randomLayouts();
+    void timingBaselines();
+private:
+    static QVector<CHeaderModel::HeaderSpan> randomSpans(StressRandom &random, int levels, int sections, int count);
+    static void checkParents(CHeaderModel *model, Qt::Orientation orientation, const ReferenceSpans *reference);
+    static void paintHeader(CHeaderView &view, RecordingStyle &style);
+    static void checkGeometry(StressHeaderView &view, StressModel &model, RecordingStyle &style);
+    static void compareWithFresh(StressHeaderView &view, StressModel &model, RecordingStyle &style);
+    static void recordTiming(QMap<QString,qint64> &timings, const QString &operation, qint64 nsecs);
+};
+
+//  :  (     ),
+//   ,        
+QVector<CHeaderModel::HeaderSpan> CHeaderViewStress::randomSpans(StressRandom &random, int levels, int sections, int count)
+{
+    QVector<CHeaderModel::HeaderSpan> spans;
+    for (int i = 0; i < count; ++i)
+    {
+        CHeaderModel::HeaderSpan span;
+        int kind = random.bounded(10);
+        if (kind < 3 && !spans.isEmpty())
+        {
+            const CHeaderModel::HeaderSpan outer = spans.at(random.bounded(spans.size()));
+            span.row             = outer.row+random.bounded(outer.rowSpanCount);
+            span.column          = outer.column+random.bounded(outer.columnSpanCount);
+            span.rowSpanCount    = 1+random.bounded(outer.row+outer.rowSpanCount-span.row);
+            span.columnSpanCount = 1+random.bounded(outer.column+outer.columnSpanCount-span.column);
+        }
+        else if (kind == 3)
+        {
+            span.row             = random.bounded(levels+2)-1;
+            span.column          = random.bounded(sections+2)-1;
+            span.rowSpanCount    = random.bounded(levels+3)-1;
+            span.columnSpanCount = random.bounded(sections+3)-1;
+        }
+        else
+        {
+            span.row             = random.bounded(levels);
+            span.column          = random.bounded(sections);
+            span.rowSpanCount    = 1+random.bounded(levels-span.row);
+            span.columnSpanCount = 1+random.bounded(qMin(sections-span.column, 1+random.bounded(24)));
+        }
+        spans.append(span);
+    }
+    return spans;
+}
+
+//       :  
+//   ,         
+// ,     .    
+//    
+void CHeaderViewStress::checkParents(CHeaderModel *model, Qt::Orientation orientation, const ReferenceSpans *reference)
+{
+    int levels   = model->headerCount(orientation),
+        sections = orientation == Qt::Horizontal? model->columnCount() : model->rowCount();
+
+    for (int row = 0; row < levels; ++row)
+        for (int col = 0; col < sections; ++col)
+        {
+            QString cell = QString("cell %1,%2").arg(row).arg(col);
+            QModelIndex parent = model->headerIndex(orientation, row, col);
+            QVERIFY2(parent.isValid(), qPrintable(cell));
+            QVERIFY2(model->headerIndex(orientation, parent.row(), parent.column()) == parent,
+                     qPrintable(cell+": parent belongs to another span"));
+
+            int columnSpan = model->headerData(parent, orientation, CHeaderModel::SectionSpanRole).toInt(),
+                rowSpan    = model->headerData(parent, orientation, CHeaderModel::LevelSpanRole).toInt();
+            QVERIFY2(parent.row() <= row && row < parent.row()+rowSpan &&
+                     parent.column() <= col && col < parent.column()+columnSpan,
+                     qPrintable(cell+": parent span does not cover the cell"));
+            QVERIFY2(parent.row()+rowSpan <= levels && parent.column()+columnSpan <= sections,
+                     qPrintable(cell+": span exceeds the header"));
+
+            if (parent.row() == row && parent.column() == col)
+                for (int r = row; r < row+rowSpan; ++r)
+                    for (int c = col; c < col+columnSpan; ++c)
+                        QVERIFY2(model->headerIndex(orientation, r, c) == parent,
+                                 qPrintable(cell+QString(": covered cell %1,%2 has another parent").arg(r).arg(c)));
+
+            if (reference)
+            {
+                CHeaderModel::HeaderSpan expected = reference->spanAt(row, col);
+                QVERIFY2(expected.row == parent.row() && expected.column == parent.column() &&
+                         expected.rowSpanCount == rowSpan && expected.columnSpanCount == columnSpan,
+                         qPrintable(cell+QString(": span %1,%2 %3x%4, expected %5,%6 %7x%8")
+                                    .arg(parent.row()).arg(parent.column()).arg(rowSpan).arg(columnSpan)
+                                    .arg(expected.row).arg(expected.column)
+                                    .arg(expected.rowSpanCount).arg(expected.columnSpanCount)));
+            }
+        }
+}
+
+//     :   
+//      
+void CHeaderViewStress::paintHeader(CHeaderView &view, RecordingStyle &style)
+{
+    style.rects.clear();
+    style.conflicts.clear();
+    QImage image(1, 1, QImage::Format_ARGB32_Premultiplied);
+    QPainter painter(&image);
+    view.exportHeader(&painter, 97);
+}
+
+//         
+// (     ),    ,
+//      ,    
+void CHeaderViewStress::checkGeometry(StressHeaderView &view, StressModel &model, RecordingStyle &style)
+{
+    Qt::Orientation orientation = view.orientation();
+    paintHeader(view, style);
+    QVERIFY2(style.conflicts.isEmpty(), qPrintable("cell painted at different places: "+style.conflicts.join(", ")));
+
+    QHash<QString,QPoint> positions = model.labelPositions();
+    QSize size = view.exportSize();
+    QRect header(QPoint(0,0), size);
+    QVector<int> xs, ys;
+    xs << 0 << size.width();
+    ys << 0 << size.height();
+
+    for (QHash<QString,QRect>::const_iterator it = style.rects.constBegin(); it != style.rects.constEnd(); ++it)
+    {
+        QVERIFY2(positions.contains(it.key()), qPrintable("unknown cell painted: "+it.key()));
+        QPoint cell = positions.value(it.key());
+        QModelIndex index = model.headerIndex(orientation, cell.x(), cell.y());
+        QString name = QString("cell %1,%2").arg(cell.x()).arg(cell.y());
+        QVERIFY2(index.row() == cell.x() && index.column() == cell.y(), qPrintable(name+": covered cell painted"));
+
+        const QRect &rect = it.value();
+        if (rect.isEmpty())
+            continue;
+        QVERIFY2(header.contains(rect), qPrintable(name+": painted outside the header"));
+        xs << rect.left() << rect.right()+1;
+        ys << rect.top() << rect.bottom()+1;
+
+        QPoint points[3] = {rect.center(), rect.topLeft(), rect.bottomRight()};
+        for (int i = 0; i < 3; ++i)
+            QVERIFY2(view.IndexAt(points[i]) == index,
+                     qPrintable(name+QString(": hit test at %1,%2").arg(points[i].x()).arg(points[i].y())));
+    }
+
+    std::sort(xs.begin(), xs.end());
+    xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+    std::sort(ys.begin(), ys.end());
+    ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+    int columns = xs.size()-1,
+        rows    = ys.size()-1;
+    QVector<int> coverage(qMax(0, columns*rows), 0);
+
+    for (QHash<QString,QRect>::const_iterator it = style.rects.constBegin(); it != style.rects.constEnd(); ++it)
+    {
+        const QRect &rect = it.value();
+        if (rect.isEmpty())
+            continue;
+        int left   = std::lower_bound(xs.constBegin(), xs.constEnd(), rect.left())-xs.constBegin(),
+            right  = std::lower_bound(xs.constBegin(), xs.constEnd(), rect.right()+1)-xs.constBegin(),
+            top    = std::lower_bound(ys.constBegin(), ys.constEnd(), rect.top())-ys.constBegin(),
+            bottom = std::lower_bound(ys.constBegin(), ys.constEnd(), rect.bottom()+1)-ys.constBegin();
+        for (int y = top; y < bottom; ++y)
+            for (int x = left; x < right; ++x)
+                ++coverage[y*columns+x];
+    }
+    for (int y = 0; y < rows; ++y)
+        for (int x = 0; x < columns; ++x)
+            QVERIFY2(coverage.at(y*columns+x) == 1,
+                     qPrintable(QString("%1 cells cover the header at %2,%3 (%4)")
+                                .arg(coverage.at(y*columns+x)).arg(xs.at(x)).arg(ys.at(y))
+                                .arg(orientation == Qt::Horizontal? "horizontal" : "vertical")));
+}
+
+// ,    ,   
+// ,   (       )
+void CHeaderViewStress::compareWithFresh(StressHeaderView &view, StressModel &model, RecordingStyle &style)
+{
+    paintHeader(view, style);
+    QHash<QString,QRect> painted = style.rects;
+
+    StressHeaderView fresh(view.orientation());
+    fresh.setStyle(&style);
+    fresh.setDefaultSectionSize(view.defaultSectionSize());
+    fresh.setModel(&model);
+    QCOMPARE(fresh.count(), view.count());
+    for (int section = 0; section < view.count(); ++section)
+    {
+        if (view.isSectionHidden(section))
+            fresh.setSectionHidden(section, true);
+        else
+            fresh.resizeSection(section, view.sectionSize(section));
+    }
+    QCOMPARE(fresh.exportSize(), view.exportSize());
+
+    paintHeader(fresh, style);
+    for (QHash<QString,QRect>::const_iterator it = style.rects.constBegin(); it != style.rects.constEnd(); ++it)
+        QVERIFY2(painted.value(it.key()) == it.value(),
+                 qPrintable(QString("cell %1 differs from fresh layout").arg(it.key())));
+    QCOMPARE(painted.size(), style.rects.size());
+}
+
+// ,    ,   :  
+//      ,  headerSpanChanged
+//    
+void CHeaderViewStress::overlappingSpan()
+{
+    const Qt::Orientation o = Qt::Horizontal;
+    StressModel model(o, 3, 10, 1);
+    model.headerSpan(o, 0, 0, 1, 4);
+    model.headerSpan(o, 1, 7, 2, 3);
+
+    qRegisterMetaType<Qt::Orientation>("Qt::Orientation");
+    QSignalSpy spy(&model, SIGNAL(headerSpanChanged(Qt::Orientation,int,int)));
+    model.headerSpan(o, 0, 2, 2, 4);
+
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(1).toInt(), 0);
+    QCOMPARE(spy.at(0).at(2).toInt(), 5);
+
+    for (int col = 0; col < 2; ++col)
+    {
+        QModelIndex parent = model.headerIndex(o, 0, col);
+        QCOMPARE(parent.row(), 0);
+        QCOMPARE(parent.column(), col);
+        QCOMPARE(model.headerData(parent, o, CHeaderModel::SectionSpanRole).toInt(), 1);
+    }
+    for (int row = 0; row < 2; ++row)
+        for (int col = 2; col < 6; ++col)
+        {
+            QModelIndex parent = model.headerIndex(o, row, col);
+            QCOMPARE(parent.row(), 0);
+            QCOMPARE(parent.column(), 2);
+        }
+    QModelIndex parent = model.headerIndex(o, 0, 2);
+    QCOMPARE(model.headerData(parent, o, CHeaderModel::LevelSpanRole).toInt(), 2);
+    QCOMPARE(model.headerData(parent, o, CHeaderModel::SectionSpanRole).toInt(), 4);
+
+    // ,    , 
+    parent = model.headerIndex(o, 2, 9);
+    QCOMPARE(parent.row(), 1);
+    QCOMPARE(parent.column(), 7);
+
+    ReferenceSpans reference(3, 10);
+    CHeaderModel::HeaderSpan spans[3] = {{0, 0, 1, 4}, {1, 7, 2, 3}, {0, 2, 2, 4}};
+    for (int i = 0; i < 3; ++i)
+        reference.add(spans[i]);
+    checkParents(&model, o, &reference);
+}
+
+void CHeaderViewStress::randomLayouts_data()
+{
+    QTest::addColumn<int>("orientation");
+    QTest::addColumn<uint>("seed");
+
+    bool ok;
+    int iterations = qEnvironmentVariableIntValue("CHEADERVIEW_STRESS_ITERATIONS", &ok);
+    if (!ok)
+        iterations = 40;
+    int first = qEnvironmentVariableIntValue("CHEADERVIEW_STRESS_SEED", &ok);
+    if (!ok)
+        first = 1;
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        uint seed = uint(first+i);
+        QTest::newRow(qPrintable(QString("horizontal/%1").arg(seed))) << int(Qt::Horizontal) << seed;
+        QTest::newRow(qPrintable(QString("vertical/%1").arg(seed)))   << int(Qt::Vertical) << seed;
+    }
+}
+
+//  :    , ,   
+//   ,  ,      .
+// ,     ,    ,
+//         
+void CHeaderViewStress::randomLayouts()
+{
+    QFETCH(int, orientation);
+    QFETCH(uint, seed);
+
+    Qt::Orientation o = Qt::Orientation(orientation);
+    StressRandom random(seed);
+    int levels   = 1+random.bounded(6),
+        sections = 1+random.bounded(160);
+
+    StressModel model(o, levels, sections, seed);
+    StressModel bulk(o, levels, sections, seed);
+    ReferenceSpans reference(levels, sections);
+    QVector<CHeaderModel::HeaderSpan> spans = randomSpans(random, levels, sections,
+                                                          random.bounded(levels*sections/3+2));
+    for (int i = 0; i < spans.size(); ++i)
+    {
+        const CHeaderModel::HeaderSpan &span = spans.at(i);
+        model.headerSpan(o, span.row, span.column, span.rowSpanCount, span.columnSpanCount);
+        reference.add(span);
+    }
+    bulk.headerSetSpans(o, spans);
+
+    checkParents(&model, o, &reference);
+    if (QTest::currentTestFailed())
+        return;
+    checkParents(&bulk, o, &reference);
+    if (QTest::currentTestFailed())
+        return;
+
+    RecordingStyle style;
+    StressHeaderView view(o);
+    view.setStyle(&style);
+    view.setDefaultSectionSize(8+random.bounded(40));
+    view.setModel(&model);
+    for (int section = 0; section < sections; ++section)
+    {
+        if (random.chance(10))
+            view.setSectionHidden(section, true);
+        else if (random.chance(20))
+            view.resizeSection(section, 1+random.bounded(80));
+    }
+    checkGeometry(view, model, style);
+    if (QTest::currentTestFailed())
+        return;
+
+    for (int step = 0; step < 8; ++step)
+    {
+        int count = model.sectionCount();
+        switch (random.bounded(6))
+        {
+        case 0:
+        {
+            CHeaderModel::HeaderSpan span = randomSpans(random, levels, qMax(1, count), 1).first();
+            model.headerSpan(o, span.row, span.column, span.rowSpanCount, span.columnSpanCount);
+            break;
+        }
+        case 1:
+            if (count > 0)
+                model.relabel(random.bounded(levels), random.bounded(count));
+            break;
+        case 2:
+            model.insertHeaderSections(random.bounded(count+1), 1+random.bounded(8));
+            break;
+        case 3:
+            if (count > 1)
+            {
+                int first   = random.bounded(count),
+                    removed = 1+random.bounded(qMin(8, count-first));
+                if (removed < count)
+                    model.removeHeaderSections(first, removed);
+            }
+            break;
+        case 4:
+            if (count > 1)
+            {
+                int first       = random.bounded(count),
+                    moved       = 1+random.bounded(qMin(8, count-first)),
+                    destination = random.bounded(count-moved+1);
+                if (destination > first)
+                    destination += moved;
+                model.moveHeaderSections(first, moved, destination);
+            }
+            break;
+        default:
+            if (count > 0)
+                view.setGroupCollapsed(random.bounded(levels), random.bounded(count), random.chance(50));
+        }
+
+        checkParents(&model, o, 0);
+        if (QTest::currentTestFailed())
+            return;
+        checkGeometry(view, model, style);
+        if (QTest::currentTestFailed())
+            return;
+        compareWithFresh(view, model, style);
+        if (QTest::currentTestFailed())
+            return;
+    }
+}
+
+void CHeaderViewStress::recordTiming(QMap<QString,qint64> &timings, const QString &operation, qint64 nsecs)
+{
+    if (!timings.contains(operation) || nsecs < timings.value(operation))
+        timings.insert(operation, nsecs);
+}
+
+//       (20000 , 4 ,   4, 16
+//  64 ;   5 )      
+// CHEADERVIEW_BASELINES.         
+// (    0.5 )  .      
+void CHeaderViewStress::timingBaselines()
+{
+    const Qt::Orientation o = Qt::Horizontal;
+    const int levels = 4, sections = 20000;
+
+    StressModel model(o, levels, sections, 1);
+    QVector<CHeaderModel::HeaderSpan> spans;
+    for (int row = 0; row < levels-1; ++row)
+    {
+        int width = 4 << 2*(levels-2-row);
+        for (int col = 0; col < sections; col += width)
+        {
+            CHeaderModel::HeaderSpan span;
+            span.row             = row;
+            span.column          = col;
+            span.rowSpanCount    = 1;
+            span.columnSpanCount = width;
+            spans.append(span);
+        }
+    }
+    model.headerSetSpans(o, spans);
+
+    StressHeaderView view(o);
+    view.resize(1920, 100);
+    view.setModel(&model);
+    view.findCells("0.", Qt::MatchStartsWith);
+
+    QMap<QString,qint64> timings;
+    QElapsedTimer timer;
+    for (int run = 0; run < 5; ++run)
+    {
+        timer.start();
+        model.headerSetSpans(o, spans);
+        recordTiming(timings, "headerSetSpans", timer.nsecsElapsed());
+
+        timer.start();
+        view.reset();
+        recordTiming(timings, "layout", timer.nsecsElapsed());
+
+        QSize size = view.exportSize();
+        QImage tile(2048, size.height(), QImage::Format_ARGB32_Premultiplied);
+        timer.start();
+        for (int position = 0; position < view.length(); position += tile.width())
+        {
+            QPainter painter(&tile);
+            view.exportTile(&painter, position, tile.width());
+        }
+        recordTiming(timings, "export", timer.nsecsElapsed());
+
+        timer.start();
+        for (int x = 0; x < view.length(); x += 7)
+            for (int y = 0; y < size.height(); y += 8)
+                view.IndexAt(x, y);
+        recordTiming(timings, "indexAt", timer.nsecsElapsed());
+
+        timer.start();
+        view.findCells("77", Qt::MatchContains);
+        recordTiming(timings, "findCells", timer.nsecsElapsed());
+
+        timer.start();
+        model.insertHeaderSections(sections/2, 16);
+        model.removeHeaderSections(sections/2, 16);
+        recordTiming(timings, "insertRemove", timer.nsecsElapsed());
+    }
+
+    for (QMap<QString,qint64>::const_iterator it = timings.constBegin(); it != timings.constEnd(); ++it)
+        qDebug("%s: %.3f ms", qPrintable(it.key()), it.value()/1e6);
+
+    QString fileName = QString::fromLocal8Bit(qgetenv("CHEADERVIEW_BASELINES"));
+    if (!qgetenv("CHEADERVIEW_RECORD_BASELINES").isEmpty())
+    {
+        QVERIFY2(!fileName.isEmpty(), "CHEADERVIEW_BASELINES is not set");
+        QFile file(fileName);
+        QVERIFY2(file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text), qPrintable(fileName));
+        QTextStream stream(&file);
+        for (QMap<QString,qint64>::const_iterator it = timings.constBegin(); it != timings.constEnd(); ++it)
+            stream << it.key() << ' ' << it.value() << '\n';
+        return;
+    }
+
+    QFile file(fileName);
+    if (fileName.isEmpty() || !file.open(QIODevice::ReadOnly | QIODevice::Text))
+        QSKIP("No recorded baselines (record with CHEADERVIEW_RECORD_BASELINES=1)");
+
+    bool ok;
+    double tolerance = qgetenv("CHEADERVIEW_BASELINE_TOLERANCE").toDouble(&ok);
+    if (!ok || tolerance < 1)
+        tolerance = 1.5;
+
+    QTextStream stream(&file);
+    while (!stream.atEnd())
+    {
+#if QT_VERSION >= QT_VERSION_CHECK(5,14,0)
+        QStringList fields = stream.readLine().split(' ', Qt::SkipEmptyParts);
+#else
+        QStringList fields = stream.readLine().split(' ', QString::SkipEmptyParts);
+#endif
+        if (fields.size() != 2 || !timings.contains(fields.at(0)))
+            continue;
+        qint64 baseline = fields.at(1).toLongLong(),
+               limit    = qMax(qint64(baseline*tolerance), baseline+500000),
+               measured = timings.value(fields.at(0));
+        QVERIFY2(measured <= limit, qPrintable(QString("%1: %2 ms, baseline %3 ms")
+                                               .arg(fields.at(0)).arg(measured/1e6).arg(baseline/1e6)));
+    }
+}
+
+QTEST_MAIN(CHeaderViewStress)
+
+#include "CHeaderViewStress.moc"